@@ -1,183 +1,1210 @@
-// bresenham_thick_glut.cpp
-// Compile (Linux): g++ bresenham_thick_glut.cpp -o bresenham_thick -lGL -lGLU -lglut -std=c++17
-// In Code::Blocks, add -lglut -lGL -lGLU to linker settings.
-
-#include <GL/glut.h>
-#include <vector>
-#include <utility>
-#include <cmath>
-#include <iostream>
-#include <algorithm>
-
-int winWidth = 900;
-int winHeight = 600;
-
-// store pixel coordinates to draw
-std::vector<std::pair<int,int>> pixels;
-
-// Clamp helper
-inline int clamp(int v, int lo, int hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
-
-// Bresenham's line algorithm (handles all octants)
-void bresenhamLine(int x0, int y0, int x1, int y1, std::vector<std::pair<int,int>>& outPixels) {
-    if (x0 == x1 && y0 == y1) {
-        outPixels.emplace_back(x0, y0);
-        return;
-    }
-
-    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
-    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
-
-    if (x0 > x1) {
-        std::swap(x0, x1);
-        std::swap(y0, y1);
-    }
-
-    int dx = x1 - x0;
-    int dy = std::abs(y1 - y0);
-    int error = dx / 2;
-    int ystep = (y0 < y1) ? 1 : -1;
-    int y = y0;
-
-    for (int x = x0; x <= x1; ++x) {
-        if (steep) outPixels.emplace_back(y, x);
-        else       outPixels.emplace_back(x, y);
-
-        error -= dy;
-        if (error < 0) {
-            y += ystep;
-            error += dx;
-        }
-    }
-}
-
-// Draw horizontal span from x1..x2 at y (append to vector if inside window)
-inline void drawHSpan(int cx, int x1, int x2, int y, std::vector<std::pair<int,int>>& outPixels) {
-    if (y < 0 || y >= winHeight) return;
-    int sx = clamp(x1, 0, winWidth - 1);
-    int ex = clamp(x2, 0, winWidth - 1);
-    if (ex < 0 || sx > winWidth - 1) return;
-    for (int x = sx; x <= ex; ++x) outPixels.emplace_back(x, y);
-}
-
-// Midpoint circle fill using 8-way symmetry with horizontal span filling
-// center (cx, cy), radius r >= 0
-// Uses integer arithmetic only for the circle rasterization
-void drawFilledCircleSymmetry(int cx, int cy, int r, std::vector<std::pair<int,int>>& outPixels) {
-    if (r <= 0) {
-        // single pixel
-        if (cx >= 0 && cx < winWidth && cy >= 0 && cy < winHeight)
-            outPixels.emplace_back(cx, cy);
-        return;
-    }
-
-    int x = r;
-    int y = 0;
-    int d = 1 - r;
-
-    // For each (x,y) on the circle octant, draw horizontal spans for the symmetric y-levels.
-    while (x >= y) {
-        // Draw spans for the 8 symmetric points by converting each symmetric arc to horizontal spans:
-        // For the pair (x, y): horizontal spans at cy +/- y from cx - x .. cx + x
-        drawHSpan(cx, cx - x, cx + x, cy + y, outPixels);
-        if (y != 0) drawHSpan(cx, cx - x, cx + x, cy - y, outPixels);
-
-        // For the pair (y, x): horizontal spans at cy +/- x from cx - y .. cx + y
-        if (x != y) {
-            drawHSpan(cx, cx - y, cx + y, cy + x, outPixels);
-            if (x != 0) drawHSpan(cx, cx - y, cx + y, cy - x, outPixels);
-        }
-
-        ++y;
-        if (d < 0) {
-            d += 2*y + 1;
-        } else {
-            --x;
-            d += 2*(y - x) + 1;
-        }
-    }
-}
-
-// Build thick line: for each Bresenham center pixel draw a filled circle radius r
-// r = floor(W/2)
-void buildThickLine(int x0, int y0, int x1, int y1, int W, std::vector<std::pair<int,int>>& outPixels) {
-    outPixels.clear();
-    std::vector<std::pair<int,int>> centers;
-    bresenhamLine(x0, y0, x1, y1, centers);
-
-    int r = std::max(0, W/2);
-    // To reduce duplicate pixels we can reserve and optionally unique later.
-    // We'll just append and then unique at the end.
-    for (const auto &p : centers) {
-        drawFilledCircleSymmetry(p.first, p.second, r, outPixels);
-    }
-
-    // Remove duplicates to reduce drawing cost
-    std::sort(outPixels.begin(), outPixels.end());
-    outPixels.erase(std::unique(outPixels.begin(), outPixels.end()), outPixels.end());
-}
-
-// OpenGL display callback
-void display() {
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glPointSize(1.0f);
-    glBegin(GL_POINTS);
-    for (const auto &p : pixels) {
-        glVertex2i(p.first, p.second);
-    }
-    glEnd();
-
-    glutSwapBuffers();
-}
-
-// Set up orthographic 2D projection matching window pixels
-void setupOrtho(int width, int height) {
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0.0, width, 0.0, height); // origin at bottom-left
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-}
-
-int main(int argc, char** argv) {
-    std::cout << "Bresenham Thick Line Drawing (GLUT)\n";
-    std::cout << "Window size: " << winWidth << " x " << winHeight << "\n";
-    std::cout << "Enter two endpoints (x0 y0 x1 y1) and desired integer line width W.\n";
-    std::cout << "Coordinates should be integers within window. Example: 50 50 700 500 7\n\n";
-
-    int x0, y0, x1, y1, W;
-    std::cout << "Enter x0 y0 x1 y1 W: ";
-    if (!(std::cin >> x0 >> y0 >> x1 >> y1 >> W)) {
-        std::cerr << "Invalid input. Exiting.\n";
-        return 0;
-    }
-
-    // clamp coords & ensure W >= 1
-    x0 = clamp(x0, 0, winWidth - 1);
-    x1 = clamp(x1, 0, winWidth - 1);
-    y0 = clamp(y0, 0, winHeight - 1);
-    y1 = clamp(y1, 0, winHeight - 1);
-    if (W < 1) W = 1;
-
-    // build the thick line pixel list
-    buildThickLine(x0, y0, x1, y1, W, pixels);
-
-    // init GLUT & create window
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
-    glutInitWindowSize(winWidth, winHeight);
-    glutInitWindowPosition(100, 100);
-    glutCreateWindow("Bresenham Thick Line Drawing");
-
-    // background black, drawing in white
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glColor3f(1.0f, 1.0f, 1.0f);
-
-    setupOrtho(winWidth, winHeight);
-
-    glutDisplayFunc(display);
-    glutMainLoop();
-
-    return 0;
-}
+// bresenham_thick_glut.cpp
+// Compile (Linux): g++ bresenham_thick_glut.cpp -o bresenham_thick -lGL -lGLU -lglut -std=c++17 -pthread
+// Add -DENABLE_INSTRUMENTATION for per-stage counters and timers (instrumentation.h).
+// In Code::Blocks, add -lglut -lGL -lGLU to linker settings.
+
+#include <GL/glut.h>
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <random>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "instrumentation.h"
+
+int winWidth = 900;
+int winHeight = 600;
+
+// store pixel coordinates to draw
+std::vector<std::pair<int,int>> pixels;
+
+// Software framebuffer memory layouts. Tiled layouts keep an 8x8 or 16x16 block
+// of pixels contiguous, so vertical runs (steep lines) and round stamps touch
+// far fewer cache lines than with plain rows.
+enum class FbLayout { RowMajor, Tiled8, Tiled16 };
+
+const char* layoutName(FbLayout l) {
+    switch (l) {
+        case FbLayout::Tiled8:  return "tiled 8x8";
+        case FbLayout::Tiled16: return "tiled 16x16";
+        default:                return "row-major";
+    }
+}
+
+// One byte (intensity) per pixel; origin at bottom-left like the GL projection
+struct Framebuffer {
+    int width = 0, height = 0;
+    FbLayout layout = FbLayout::RowMajor;
+    int tileShift = 0;      // log2 of tile edge (0 = row-major)
+    int tilesPerRow = 0;
+    int stride = 0;         // padded width in pixels
+    std::vector<unsigned char> data;
+
+    void init(int w, int h, FbLayout l) {
+        width = w; height = h; layout = l;
+        tileShift = (l == FbLayout::Tiled8) ? 3 : (l == FbLayout::Tiled16) ? 4 : 0;
+        int tile = 1 << tileShift;
+        stride = (w + tile - 1) & ~(tile - 1);
+        int paddedH = (h + tile - 1) & ~(tile - 1);
+        tilesPerRow = stride >> tileShift;
+        data.assign(size_t(stride) * paddedH, 0);
+    }
+
+    void clear(unsigned char v = 0) { std::fill(data.begin(), data.end(), v); }
+
+    inline size_t offset(int x, int y) const {
+        if (tileShift == 0) return size_t(y) * stride + x;
+        int mask = (1 << tileShift) - 1;
+        size_t tileIndex = size_t(y >> tileShift) * tilesPerRow + (x >> tileShift);
+        return (tileIndex << (2 * tileShift)) + (size_t(y & mask) << tileShift) + (x & mask);
+    }
+
+    inline void set(int x, int y, unsigned char v) { data[offset(x, y)] = v; }
+    inline unsigned char get(int x, int y) const { return data[offset(x, y)]; }
+
+    // Convert to a tightly packed row-major image (for glDrawPixels / encoding).
+    // Tiled layouts copy whole tile rows at a time.
+    void detile(std::vector<unsigned char>& out) const {
+        out.resize(size_t(width) * height);
+        if (tileShift == 0) {
+            for (int y = 0; y < height; ++y)
+                std::memcpy(&out[size_t(y) * width], &data[size_t(y) * stride], width);
+            return;
+        }
+        int tile = 1 << tileShift;
+        for (int ty = 0; ty * tile < height; ++ty) {
+            for (int tx = 0; tx < tilesPerRow; ++tx) {
+                const unsigned char* src = &data[(size_t(ty) * tilesPerRow + tx) << (2 * tileShift)];
+                int x0 = tx * tile;
+                int n = std::min(tile, width - x0);
+                for (int r = 0; r < tile; ++r) {
+                    int y = ty * tile + r;
+                    if (y >= height) break;
+                    std::memcpy(&out[size_t(y) * width + x0], src + (r << tileShift), n);
+                }
+            }
+        }
+    }
+};
+
+FbLayout fbLayout = FbLayout::RowMajor;
+Framebuffer framebuffer;
+std::vector<unsigned char> uploadBuffer;   // row-major copy handed to GL
+
+// Anti-aliased thick lines: coverage from the signed distance to the segment,
+// written straight into the framebuffer (toggled with 'a')
+bool useAntialiasedLines = false;
+int lineX0, lineY0, lineX1, lineY1, lineWidth;   // the line entered at startup
+
+// Clamp helper
+inline int clamp(int v, int lo, int hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
+
+// Bresenham's line algorithm (handles all octants)
+void bresenhamLine(int x0, int y0, int x1, int y1, std::vector<std::pair<int,int>>& outPixels) {
+    if (x0 == x1 && y0 == y1) {
+        outPixels.emplace_back(x0, y0);
+        return;
+    }
+
+    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    int dx = x1 - x0;
+    int dy = std::abs(y1 - y0);
+    int error = dx / 2;
+    int ystep = (y0 < y1) ? 1 : -1;
+    int y = y0;
+
+    for (int x = x0; x <= x1; ++x) {
+        if (steep) outPixels.emplace_back(y, x);
+        else       outPixels.emplace_back(x, y);
+
+        error -= dy;
+        if (error < 0) {
+            y += ystep;
+            error += dx;
+        }
+    }
+}
+
+// Draw horizontal span from x1..x2 at y (append to vector if inside window)
+inline void drawHSpan(int cx, int x1, int x2, int y, std::vector<std::pair<int,int>>& outPixels) {
+    if (y < 0 || y >= winHeight) return;
+    if (x2 < 0 || x1 > winWidth - 1) return;   // entirely off-screen (test before clamping)
+    int sx = clamp(x1, 0, winWidth - 1);
+    int ex = clamp(x2, 0, winWidth - 1);
+    for (int x = sx; x <= ex; ++x) outPixels.emplace_back(x, y);
+}
+
+// Midpoint circle fill using 8-way symmetry with horizontal span filling
+// center (cx, cy), radius r >= 0
+// Uses integer arithmetic only for the circle rasterization
+void drawFilledCircleSymmetry(int cx, int cy, int r, std::vector<std::pair<int,int>>& outPixels) {
+    if (r <= 0) {
+        // single pixel
+        if (cx >= 0 && cx < winWidth && cy >= 0 && cy < winHeight)
+            outPixels.emplace_back(cx, cy);
+        return;
+    }
+
+    int x = r;
+    int y = 0;
+    int d = 1 - r;
+
+    // For each (x,y) on the circle octant, draw horizontal spans for the symmetric y-levels.
+    while (x >= y) {
+        // Draw spans for the 8 symmetric points by converting each symmetric arc to horizontal spans:
+        // For the pair (x, y): horizontal spans at cy +/- y from cx - x .. cx + x
+        drawHSpan(cx, cx - x, cx + x, cy + y, outPixels);
+        if (y != 0) drawHSpan(cx, cx - x, cx + x, cy - y, outPixels);
+
+        // For the pair (y, x): horizontal spans at cy +/- x from cx - y .. cx + y
+        if (x != y) {
+            drawHSpan(cx, cx - y, cx + y, cy + x, outPixels);
+            if (x != 0) drawHSpan(cx, cx - y, cx + y, cy - x, outPixels);
+        }
+
+        ++y;
+        if (d < 0) {
+            d += 2*y + 1;
+        } else {
+            --x;
+            d += 2*(y - x) + 1;
+        }
+    }
+}
+
+// Midpoint ellipse modes: outline pixels, or one horizontal span per covered row
+enum class EllipseMode { Outline, Filled };
+
+// Integer midpoint ellipse centered at (cx, cy) with semi-axes a (x) and b (y).
+// Walks one quadrant (region 1 while the slope is > -1, then region 2) and uses
+// 4-way symmetry; output goes through drawHSpan like the circle kernel.
+// Decision variables are 64-bit, so semi-axes up to 2^15 cannot overflow
+// (largest term is a^2 * b^2 <= 2^60).
+void drawEllipseMidpoint(int cx, int cy, int a, int b, EllipseMode mode,
+                         std::vector<std::pair<int,int>>& outPixels) {
+    if (a <= 0 || b <= 0) {
+        // degenerate: a line (or point) along the non-zero axis
+        drawHSpan(cx, cx - std::max(a, 0), cx + std::max(a, 0), cy, outPixels);
+        for (int y = 1; y <= b; ++y) {
+            drawHSpan(cx, cx, cx, cy + y, outPixels);
+            drawHSpan(cx, cx, cx, cy - y, outPixels);
+        }
+        return;
+    }
+
+    const long long a2 = (long long)a * a;
+    const long long b2 = (long long)b * b;
+
+    // emit the 4 symmetric points / the 2 symmetric rows for quadrant point (x, y)
+    auto plot4 = [&](int x, int y) {
+        drawHSpan(cx, cx + x, cx + x, cy + y, outPixels);
+        if (x != 0) drawHSpan(cx, cx - x, cx - x, cy + y, outPixels);
+        if (y != 0) {
+            drawHSpan(cx, cx + x, cx + x, cy - y, outPixels);
+            if (x != 0) drawHSpan(cx, cx - x, cx - x, cy - y, outPixels);
+        }
+    };
+    auto spanRows = [&](int x, int y) {
+        drawHSpan(cx, cx - x, cx + x, cy + y, outPixels);
+        if (y != 0) drawHSpan(cx, cx - x, cx + x, cy - y, outPixels);
+    };
+
+    int x = 0;
+    int y = b;
+    long long dx = 0;            // 2 * b^2 * x
+    long long dy = 2 * a2 * y;   // 2 * a^2 * y
+
+    // Region 1: x advances every step, y sometimes
+    long long d1 = b2 - a2 * b + a2 / 4;
+    while (dx < dy) {
+        if (mode == EllipseMode::Outline) plot4(x, y);
+        if (d1 < 0) {
+            ++x;
+            dx += 2 * b2;
+            d1 += dx + b2;
+        } else {
+            // row y is finished: its widest extent is x
+            if (mode == EllipseMode::Filled) spanRows(x, y);
+            ++x; --y;
+            dx += 2 * b2;
+            dy -= 2 * a2;
+            d1 += dx - dy + b2;
+        }
+    }
+
+    // Region 2: y decreases every step, x sometimes
+    long long d2 = a2 * ((long long)(y - 1) * (y - 1) - b2) + b2 * ((long long)x * x + x) + b2 / 4;
+    while (y >= 0) {
+        if (mode == EllipseMode::Outline) plot4(x, y);
+        else spanRows(x, y);
+        if (d2 > 0) {
+            --y;
+            dy -= 2 * a2;
+            d2 += a2 - dy;
+        } else {
+            --y; ++x;
+            dx += 2 * b2;
+            dy -= 2 * a2;
+            d2 += dx - dy + a2;
+        }
+    }
+}
+
+// Filled ellipse with a == b against the midpoint circle kernel (same radius)
+void benchmarkEllipseVsCircle() {
+    std::vector<std::pair<int,int>> out;
+    out.reserve(1 << 20);
+    const int reps = 200, r = 250;
+    int cx = winWidth / 2, cy = winHeight / 2;
+
+    auto timeIt = [&](auto&& fn) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; ++i) { out.clear(); fn(); }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+    };
+    double tc = timeIt([&] { drawFilledCircleSymmetry(cx, cy, r, out); });
+    size_t circlePixels = out.size();
+    double te = timeIt([&] { drawEllipseMidpoint(cx, cy, r, r, EllipseMode::Filled, out); });
+    size_t ellipsePixels = out.size();
+    std::cout << "Filled r=" << r << ": circle " << tc << " us (" << circlePixels << " px), ellipse "
+              << te << " us (" << ellipsePixels << " px)\n";
+}
+
+// Self-check: ellipses much larger than the window (semi-axes up to 2^15) must only
+// emit pixels near the true curve (outline) or inside it (filled), never spans
+// clamped onto the window border
+bool checkLargeEllipses() {
+    std::vector<std::pair<int,int>> out;
+    const int cases[][4] = { { 450, 300, 2000, 400 }, { 450, 300, 2000, 1500 },
+                             { -1500, 300, 1800, 250 }, { 450, 300, 32768, 32768 } };
+    for (const auto& c : cases) {
+        const double a = c[2], b = c[3];
+        for (EllipseMode mode : { EllipseMode::Outline, EllipseMode::Filled }) {
+            out.clear();
+            drawEllipseMidpoint(c[0], c[1], c[2], c[3], mode, out);
+            for (const auto& p : out) {
+                double dx = p.first - c[0], dy = p.second - c[1];
+                double f = dx * dx / (a * a) + dy * dy / (b * b) - 1.0;
+                double grad = 2.0 * std::sqrt(dx * dx / (a * a * a * a) + dy * dy / (b * b * b * b));
+                // first-order distance to the curve, in pixels
+                double dist = grad > 0 ? f / grad : -1.0;
+                bool ok = mode == EllipseMode::Outline ? std::fabs(dist) <= 1.0 : dist <= 1.0;
+                if (!ok) {
+                    std::cout << "Ellipse check FAILED: a=" << c[2] << " b=" << c[3] << " pixel ("
+                              << p.first << ", " << p.second << ") is " << dist << " px off the curve\n";
+                    return false;
+                }
+            }
+        }
+    }
+    std::cout << "Ellipse check passed (semi-axes up to 32768)\n";
+    return true;
+}
+
+// Angular bounds of an arc / pie sector, counter-clockwise from start to end.
+// Directions are integer vectors (scaled by 2^16) so the inside tests are exact
+// cross products: cross(start, p) >= 0 and cross(p, end) >= 0.
+struct SectorBounds {
+    long long sx, sy, ex, ey;
+    bool full;     // sweep covers the whole circle
+    bool convex;   // sweep <= 180: intersection of the two half-planes, else union
+};
+
+SectorBounds makeSector(double startDeg, double endDeg) {
+    const double scale = 65536.0;
+    constexpr double kPi = 3.14159265358979323846;
+    double sweep = std::fmod(endDeg - startDeg, 360.0);
+    if (sweep <= 0) sweep += 360.0;
+    SectorBounds sb;
+    double a0 = startDeg * kPi / 180.0, a1 = endDeg * kPi / 180.0;
+    sb.sx = std::llround(std::cos(a0) * scale);
+    sb.sy = std::llround(std::sin(a0) * scale);
+    sb.ex = std::llround(std::cos(a1) * scale);
+    sb.ey = std::llround(std::sin(a1) * scale);
+    sb.full = (endDeg - startDeg) >= 360.0;
+    sb.convex = sweep <= 180.0;
+    return sb;
+}
+
+// Pixel offset (x, y) from the center inside the angular bounds
+inline bool insideSector(const SectorBounds& sb, long long x, long long y) {
+    if (sb.full) return true;
+    bool afterStart = sb.sx * y - sb.sy * x >= 0;
+    bool beforeEnd  = x * sb.ey - y * sb.ex >= 0;
+    return sb.convex ? (afterStart && beforeEnd) : (afterStart || beforeEnd);
+}
+
+// Row half-widths of the midpoint disk of radius r (hw[|y|] = max x),
+// the same octant walk drawFilledCircleSymmetry uses
+void circleHalfWidths(int r, std::vector<int>& hw) {
+    hw.assign(r + 1, 0);
+    int x = r, y = 0, d = 1 - r;
+    while (x >= y) {
+        hw[y] = std::max(hw[y], x);
+        hw[x] = std::max(hw[x], y);
+        ++y;
+        if (d < 0) {
+            d += 2*y + 1;
+        } else {
+            --x;
+            d += 2*(y - x) + 1;
+        }
+    }
+}
+
+// Integer range [lo, hi] of x on one row; empty when lo > hi
+struct XRange { long long lo, hi; };
+
+inline long long floorDiv(long long a, long long b) {
+    long long q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+inline long long ceilDiv(long long a, long long b) { return -floorDiv(-a, b); }
+
+// Solve A*x <= B for integer x
+inline XRange halfPlaneRange(long long A, long long B) {
+    const long long inf = 1LL << 40;
+    if (A > 0) return {-inf, floorDiv(B, A)};
+    if (A < 0) return {ceilDiv(B, A), inf};
+    return B >= 0 ? XRange{-inf, inf} : XRange{1, 0};
+}
+
+// Annular sector: pixels of the disk of radius r minus the disk of radius r - thickness,
+// within the angular bounds. Each row is clipped to the sector analytically (the
+// cross-product half-planes solved for x), so only covered pixels are visited.
+// thickness > r gives a filled pie sector; thickness == 1 a one-pixel arc.
+void drawAnnularSector(int cx, int cy, int r, int thickness, const SectorBounds& sb,
+                       std::vector<std::pair<int,int>>& outPixels) {
+    if (r < 0 || thickness <= 0) return;
+    int ri = r - thickness;   // inner (excluded) radius, < 0 means no hole
+    std::vector<int> hwOuter, hwInner;
+    circleHalfWidths(r, hwOuter);
+    if (ri >= 0) circleHalfWidths(ri, hwInner);
+
+    for (int y = -r; y <= r; ++y) {
+        if (cy + y < 0 || cy + y >= winHeight) continue;
+        int ay = std::abs(y);
+        long long xo = hwOuter[ay];
+
+        // radial part: [-xo, xo] minus the inner disk row
+        XRange radial[2];
+        int nRadial = 0;
+        if (ri >= 0 && ay <= ri) {
+            long long xi = hwInner[ay];
+            radial[nRadial++] = {-xo, -xi - 1};
+            radial[nRadial++] = {xi + 1, xo};
+        } else {
+            radial[nRadial++] = {-xo, xo};
+        }
+
+        // angular part: one range (convex) or up to two (reflex sweep)
+        XRange angular[2];
+        int nAngular = 0;
+        if (sb.full) {
+            angular[nAngular++] = {-xo, xo};
+        } else {
+            XRange h0 = halfPlaneRange(sb.sy, sb.sx * y);    // cross(start, p) >= 0
+            XRange h1 = halfPlaneRange(-sb.ey, -sb.ex * y);  // cross(p, end) >= 0
+            if (sb.convex) {
+                angular[nAngular++] = {std::max(h0.lo, h1.lo), std::min(h0.hi, h1.hi)};
+            } else {
+                if (h0.lo > h1.lo) std::swap(h0, h1);
+                if (h0.hi + 1 >= h1.lo) angular[nAngular++] = {h0.lo, std::max(h0.hi, h1.hi)};
+                else { angular[nAngular++] = h0; angular[nAngular++] = h1; }
+            }
+        }
+
+        // screen columns as offsets from cx: spans are clipped here, before drawHSpan clamps
+        const long long screenLo = -(long long)cx, screenHi = (long long)winWidth - 1 - cx;
+        for (int i = 0; i < nRadial; ++i)
+            for (int j = 0; j < nAngular; ++j) {
+                long long lo = std::max({ radial[i].lo, angular[j].lo, screenLo });
+                long long hi = std::min({ radial[i].hi, angular[j].hi, screenHi });
+                if (lo <= hi) drawHSpan(cx, cx + (int)lo, cx + (int)hi, cy + y, outPixels);
+            }
+    }
+}
+
+// Filled pie sector and one-pixel arc on top of the annular sector
+void drawFilledSector(int cx, int cy, int r, const SectorBounds& sb,
+                      std::vector<std::pair<int,int>>& outPixels) {
+    drawAnnularSector(cx, cy, r, r + 1, sb, outPixels);
+}
+
+void drawArc(int cx, int cy, int r, const SectorBounds& sb,
+             std::vector<std::pair<int,int>>& outPixels) {
+    drawAnnularSector(cx, cy, r, 1, sb, outPixels);
+}
+
+// Self-check: sectors, arcs and annular sectors cut by the window border must only
+// emit pixels that pass insideSector and lie within the outer radius
+bool checkSectorClipping() {
+    std::vector<std::pair<int,int>> out;
+    struct Case { int cx, cy, r, thickness; double start, end; };
+    const Case cases[] = { { 10, 300, 60, 61, 135, 225 },           // pie facing left, off the left edge
+                           { 10, 300, 60, 15, 150, 210 },           // annular sector, same
+                           { winWidth - 5, 300, 80, 1, -60, 60 },   // arc off the right edge
+                           { 450, 5, 100, 101, 200, 340 },          // pie below the bottom edge
+                           { -40, -40, 200, 30, 0, 270 } };         // reflex sweep, center off-screen
+    for (const auto& c : cases) {
+        SectorBounds sb = makeSector(c.start, c.end);
+        out.clear();
+        drawAnnularSector(c.cx, c.cy, c.r, c.thickness, sb, out);
+        for (const auto& p : out) {
+            long long dx = p.first - c.cx, dy = p.second - c.cy;
+            if (!insideSector(sb, dx, dy) || dx * dx + dy * dy > (long long)(c.r + 1) * (c.r + 1)) {
+                std::cout << "Sector check FAILED: center (" << c.cx << ", " << c.cy << ") sweep "
+                          << c.start << ".." << c.end << " emitted (" << p.first << ", " << p.second << ")\n";
+                return false;
+            }
+        }
+    }
+    std::cout << "Sector check passed\n";
+    return true;
+}
+
+// Direct sector vs full disk + per-pixel cross-product mask
+void benchmarkSectors() {
+    std::vector<std::pair<int,int>> out, disk;
+    out.reserve(1 << 20);
+    disk.reserve(1 << 20);
+    const int reps = 200, r = 250;
+    int cx = winWidth / 2, cy = winHeight / 2;
+
+    auto timeIt = [&](auto&& fn) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; ++i) { out.clear(); fn(); }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+    };
+    for (double sweep : {30.0, 90.0, 270.0}) {
+        SectorBounds sb = makeSector(20.0, 20.0 + sweep);
+        double tMask = timeIt([&] {
+            disk.clear();
+            drawFilledCircleSymmetry(cx, cy, r, disk);
+            for (auto& p : disk)
+                if (insideSector(sb, p.first - cx, p.second - cy)) out.push_back(p);
+        });
+        double tDirect = timeIt([&] { drawFilledSector(cx, cy, r, sb, out); });
+        std::cout << "Sector " << sweep << " deg r=" << r << ": disk+mask " << tMask
+                  << " us, direct " << tDirect << " us (" << out.size() << " px)\n";
+    }
+}
+
+// Stamp a filled circle of radius floor(W/2) on every center pixel, then sort
+// and drop the pixels covered by more than one stamp. Appends to outPixels and
+// keeps it sorted and unique, so it can also collect several polylines.
+void stampThickPixels(const std::vector<std::pair<int,int>>& centers, int W,
+                      std::vector<std::pair<int,int>>& outPixels) {
+    int r = std::max(0, W/2);
+    {
+        INSTR_SCOPE("thick.stamp");
+        for (const auto &p : centers) {
+            drawFilledCircleSymmetry(p.first, p.second, r, outPixels);
+        }
+    }
+    size_t stamped = outPixels.size();
+
+    // Remove duplicates to reduce drawing cost
+    {
+        INSTR_SCOPE("thick.sort_unique");
+        std::sort(outPixels.begin(), outPixels.end());
+        outPixels.erase(std::unique(outPixels.begin(), outPixels.end()), outPixels.end());
+    }
+    INSTR_COUNT("thick.center_pixels", centers.size());
+    INSTR_COUNT("thick.duplicates_removed", stamped - outPixels.size());
+}
+
+// Build thick line: for each Bresenham center pixel draw a filled circle radius r
+// r = floor(W/2)
+void buildThickLine(int x0, int y0, int x1, int y1, int W, std::vector<std::pair<int,int>>& outPixels) {
+    INSTR_SCOPE("thick.total");
+    outPixels.clear();
+    std::vector<std::pair<int,int>> centers;
+    {
+        INSTR_SCOPE("thick.centers");
+        bresenhamLine(x0, y0, x1, y1, centers);
+    }
+    stampThickPixels(centers, W, outPixels);
+    INSTR_COUNT("thick.pixels_emitted", outPixels.size());
+}
+
+// Quadratic (degree 2) or cubic (degree 3) Bezier curve in pixel coordinates
+struct BezierCurve {
+    int degree;
+    float x[4], y[4];
+};
+
+// max pixel distance between a curve and its flattened polyline
+float bezierTolerancePx = 0.25f;
+
+// Wang's formula: uniform segment count that keeps the polyline within tol of
+// the curve, n = ceil(sqrt(d(d-1)/8 * M / tol)), M = largest second difference
+int wangSegmentCount(const BezierCurve& c, float tol) {
+    float m = 0.0f;
+    for (int i = 0; i + 2 <= c.degree; ++i) {
+        float ddx = c.x[i] - 2.0f * c.x[i + 1] + c.x[i + 2];
+        float ddy = c.y[i] - 2.0f * c.y[i + 1] + c.y[i + 2];
+        m = std::max(m, std::sqrt(ddx * ddx + ddy * ddy));
+    }
+    float k = c.degree * (c.degree - 1) / 8.0f;
+    int n = (int)std::ceil(std::sqrt(k * m / tol));
+    return clamp(n, 1, 4096);
+}
+
+// Point on the curve at parameter t (Bernstein form)
+inline void evalBezier(const BezierCurve& c, float t, float& px, float& py) {
+    float u = 1.0f - t;
+    if (c.degree == 2) {
+        float b0 = u * u, b1 = 2 * u * t, b2 = t * t;
+        px = b0 * c.x[0] + b1 * c.x[1] + b2 * c.x[2];
+        py = b0 * c.y[0] + b1 * c.y[1] + b2 * c.y[2];
+    } else {
+        float b0 = u * u * u, b1 = 3 * u * u * t, b2 = 3 * u * t * t, b3 = t * t * t;
+        px = b0 * c.x[0] + b1 * c.x[1] + b2 * c.x[2] + b3 * c.x[3];
+        py = b0 * c.y[0] + b1 * c.y[1] + b2 * c.y[2] + b3 * c.y[3];
+    }
+}
+
+// Flatten into n segments and rasterize them as one connected Bresenham polyline
+// (the shared vertex of consecutive segments is emitted once).
+// Returns the number of segments emitted.
+int flattenBezier(const BezierCurve& c, int n, std::vector<std::pair<int,int>>& outPixels) {
+    int px = (int)std::lround(c.x[0]), py = (int)std::lround(c.y[0]);
+    outPixels.emplace_back(px, py);
+    int emitted = 0;
+    for (int i = 1; i <= n; ++i) {
+        float fx, fy;
+        evalBezier(c, float(i) / n, fx, fy);
+        int qx = (int)std::lround(fx), qy = (int)std::lround(fy);
+        if (qx == px && qy == py) continue;   // collapsed to the same pixel
+        size_t first = outPixels.size();
+        bresenhamLine(px, py, qx, qy, outPixels);
+        // bresenhamLine may run right-to-left; drop whichever end repeats the vertex
+        if (outPixels[first] == std::make_pair(px, py)) outPixels.erase(outPixels.begin() + first);
+        else outPixels.pop_back();
+        px = qx; py = qy;
+        ++emitted;
+    }
+    return emitted;
+}
+
+// Flatten a batch of curves in parallel. tol <= 0 selects the old fixed step
+// count (fixedSteps). W > 1 strokes each curve's center pixels through
+// stampThickPixels like buildThickLine, so a curve emits every stroke pixel
+// once. segmentsPerCurve receives the segment count of every curve.
+void flattenBezierBatch(const std::vector<BezierCurve>& curves, float tol, int fixedSteps, int W,
+                        std::vector<std::pair<int,int>>& outPixels, std::vector<int>& segmentsPerCurve,
+                        unsigned threads = std::thread::hardware_concurrency()) {
+    threads = std::max(1u, std::min<unsigned>(threads, (unsigned)curves.size()));
+    segmentsPerCurve.assign(curves.size(), 0);
+    std::vector<std::vector<std::pair<int,int>>> partial(threads);
+
+    auto work = [&](unsigned tid) {
+        size_t begin = curves.size() * tid / threads, end = curves.size() * (tid + 1) / threads;
+        std::vector<std::pair<int,int>> centers, stroke;
+        for (size_t i = begin; i < end; ++i) {
+            int n = tol > 0 ? wangSegmentCount(curves[i], tol) : fixedSteps;
+            if (W <= 1) {
+                segmentsPerCurve[i] = flattenBezier(curves[i], n, partial[tid]);
+            } else {
+                centers.clear();
+                stroke.clear();
+                segmentsPerCurve[i] = flattenBezier(curves[i], n, centers);
+                stampThickPixels(centers, W, stroke);
+                partial[tid].insert(partial[tid].end(), stroke.begin(), stroke.end());
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (auto &th : pool) th.join();
+
+    outPixels.clear();
+    for (const auto &part : partial) outPixels.insert(outPixels.end(), part.begin(), part.end());
+}
+
+// Random mix of nearly flat and tightly bent curves
+std::vector<BezierCurve> randomCurves(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> px(0.0f, float(winWidth - 1)), py(0.0f, float(winHeight - 1));
+    std::uniform_real_distribution<float> jitter(-4.0f, 4.0f);
+    std::vector<BezierCurve> curves(count);
+    for (size_t i = 0; i < count; ++i) {
+        BezierCurve& c = curves[i];
+        c.degree = (i % 2) ? 3 : 2;
+        c.x[0] = px(rng); c.y[0] = py(rng);
+        c.x[c.degree] = px(rng); c.y[c.degree] = py(rng);
+        for (int k = 1; k < c.degree; ++k) {
+            float t = float(k) / c.degree;
+            if (i % 4 < 2) {   // flat: control points near the chord
+                c.x[k] = c.x[0] + (c.x[c.degree] - c.x[0]) * t + jitter(rng);
+                c.y[k] = c.y[0] + (c.y[c.degree] - c.y[0]) * t + jitter(rng);
+            } else {
+                c.x[k] = px(rng); c.y[k] = py(rng);
+            }
+        }
+    }
+    return curves;
+}
+
+// Fixed-step flattening vs Wang's formula, single thread vs all cores
+void benchmarkBezierFlattening() {
+    std::vector<BezierCurve> curves = randomCurves(4000, 7);
+    std::vector<std::pair<int,int>> out;
+    std::vector<int> segs;
+    const int fixedSteps = 64;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    auto run = [&](float tol, unsigned threads) {
+        auto t0 = std::chrono::steady_clock::now();
+        flattenBezierBatch(curves, tol, fixedSteps, 1, out, segs, threads);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+    auto report = [&](const char* name, double ms) {
+        long long total = 0;
+        int lo = segs.empty() ? 0 : segs[0], hi = lo;
+        for (int n : segs) { total += n; lo = std::min(lo, n); hi = std::max(hi, n); }
+        std::cout << "  " << name << ": " << ms << " ms, segments/curve avg "
+                  << double(total) / std::max<size_t>(1, segs.size()) << " (min " << lo << ", max " << hi
+                  << "), " << out.size() << " px\n";
+    };
+    std::cout << "Bezier flattening (" << curves.size() << " curves, " << cores << " threads):\n";
+    report("fixed 64 steps, 1 thread", run(0.0f, 1));
+    report("Wang tol 0.25px, 1 thread", run(bezierTolerancePx, 1));
+    report("Wang tol 0.25px, all threads", run(bezierTolerancePx, cores));
+    // thick strokes stamp and dedupe every curve, so time a tenth of the batch
+    std::vector<BezierCurve> strokeCurves(curves.begin(), curves.begin() + curves.size() / 10);
+    auto t0 = std::chrono::steady_clock::now();
+    flattenBezierBatch(strokeCurves, bezierTolerancePx, fixedSteps, 9, out, segs, cores);
+    report("Wang tol 0.25px, W=9 stroke of 400 curves, all threads",
+           std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+}
+
+// Bezier curves drawn over the line ('c' key), stroked at the line width
+bool showCurves = false;
+std::vector<std::pair<int,int>> curvePixels;
+
+void buildCurveStrokes() {
+    std::vector<BezierCurve> curves = randomCurves(12, 1);
+    std::vector<int> segs;
+    flattenBezierBatch(curves, bezierTolerancePx, 0, lineWidth, curvePixels, segs);
+    long long total = 0;
+    for (int n : segs) total += n;
+    std::cout << "Curves: " << curves.size() << " Bezier curves, " << total << " segments, "
+              << curvePixels.size() << " px at W=" << lineWidth << "\n";
+}
+
+// Write a pixel list into the software framebuffer
+void rasterizeToFramebuffer(const std::vector<std::pair<int,int>>& pts, Framebuffer& fb) {
+    fb.clear();
+    for (const auto &p : pts) {
+        if (p.first >= 0 && p.first < fb.width && p.second >= 0 && p.second < fb.height)
+            fb.set(p.first, p.second, 255);
+    }
+}
+
+// Time pixel writes for steep and thick lines in every framebuffer layout.
+// Pixels are written in generation order (before sorting) as a rasterizer would.
+void benchmarkFramebufferLayouts() {
+    std::vector<std::pair<int,int>> steep, thick, centers;
+    for (int i = 0; i < 64; ++i)
+        bresenhamLine(10 + i * 13, 0, 40 + i * 13, winHeight - 1, steep);
+    bresenhamLine(20, 30, winWidth - 20, winHeight - 30, centers);
+    for (const auto &p : centers) drawFilledCircleSymmetry(p.first, p.second, 8, thick);
+
+    const int reps = 20;
+    std::cout << "Framebuffer write throughput (Mpixel/s):\n";
+    for (FbLayout l : { FbLayout::RowMajor, FbLayout::Tiled8, FbLayout::Tiled16 }) {
+        Framebuffer fb;
+        fb.init(winWidth, winHeight, l);
+        double rates[2];
+        const std::vector<std::pair<int,int>>* sets[2] = { &steep, &thick };
+        for (int k = 0; k < 2; ++k) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < reps; ++rep)
+                for (const auto &p : *sets[k]) fb.set(p.first, p.second, 255);
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            rates[k] = double(sets[k]->size()) * reps / sec / 1e6;
+        }
+        std::cout << "  " << layoutName(l) << ": steep " << rates[0] << ", thick " << rates[1] << "\n";
+    }
+}
+
+// ---------------- Scanline flood fill ----------------
+
+// 16-byte SSE2 compares when scanning rows for span extents (row-major only)
+bool useSimdScan = true;
+
+// First x in [x, xEnd] whose pixel differs from v (equal == false) or equals v
+// (equal == true); xEnd + 1 when there is none
+int scanRight(const Framebuffer& fb, int y, int x, int xEnd, unsigned char v, bool equal) {
+    if (fb.tileShift == 0) {
+        const unsigned char* row = &fb.data[size_t(y) * fb.stride];
+#ifdef __SSE2__
+        if (useSimdScan) {
+            const __m128i vv = _mm_set1_epi8((char)v);
+            for (; x + 15 <= xEnd; x += 16) {
+                int m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + x)), vv));
+                if (!equal) m = ~m & 0xFFFF;
+                if (m) return x + __builtin_ctz(m);
+            }
+        }
+#endif
+        for (; x <= xEnd; ++x)
+            if ((row[x] == v) == equal) return x;
+        return x;
+    }
+    for (; x <= xEnd; ++x)
+        if ((fb.get(x, y) == v) == equal) return x;
+    return x;
+}
+
+// Last x in [xBegin, x] whose pixel differs from v; xBegin - 1 when there is none
+int scanLeft(const Framebuffer& fb, int y, int x, int xBegin, unsigned char v) {
+    if (fb.tileShift == 0) {
+        const unsigned char* row = &fb.data[size_t(y) * fb.stride];
+#ifdef __SSE2__
+        if (useSimdScan) {
+            const __m128i vv = _mm_set1_epi8((char)v);
+            for (; x - 15 >= xBegin; x -= 16) {
+                int m = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + x - 15)), vv)) & 0xFFFF;
+                if (m) return x - 15 + (31 - __builtin_clz(m));
+            }
+        }
+#endif
+        for (; x >= xBegin; --x)
+            if (row[x] != v) return x;
+        return x;
+    }
+    for (; x >= xBegin; --x)
+        if (fb.get(x, y) != v) return x;
+    return x;
+}
+
+inline void fillSpan(Framebuffer& fb, int y, int x1, int x2, unsigned char v) {
+    if (fb.tileShift == 0) std::memset(&fb.data[size_t(y) * fb.stride + x1], v, size_t(x2 - x1 + 1));
+    else for (int x = x1; x <= x2; ++x) fb.set(x, y, v);
+}
+
+// Span-stack (Smith) flood fill: replaces the connected region of pixels equal to
+// the seed's value with newValue. Each popped seed is grown into a whole span
+// and filled at once; the rows above and below are scanned over the span (one
+// pixel wider with 8-connectivity) and one seed is pushed per run found there.
+// The stack holds spans, not pixels; returns the number of pixels filled and
+// the peak stack depth in maxStack.
+size_t floodFill(Framebuffer& fb, int sx, int sy, unsigned char newValue, bool eightConnected,
+                 size_t* maxStack = nullptr) {
+    if (sx < 0 || sx >= fb.width || sy < 0 || sy >= fb.height) return 0;
+    const unsigned char target = fb.get(sx, sy);
+    if (target == newValue) return 0;
+
+    std::vector<std::pair<int,int>> stack;
+    stack.emplace_back(sx, sy);
+    size_t filled = 0, peak = 1;
+    const int grow = eightConnected ? 1 : 0;
+
+    while (!stack.empty()) {
+        auto [x, y] = stack.back();
+        stack.pop_back();
+        if (fb.get(x, y) != target) continue;   // already filled via another run
+
+        int l = scanLeft(fb, y, x, 0, target) + 1;
+        int r = scanRight(fb, y, x, fb.width - 1, target, false) - 1;
+        fillSpan(fb, y, l, r, newValue);
+        filled += size_t(r - l + 1);
+
+        int from = std::max(l - grow, 0), to = std::min(r + grow, fb.width - 1);
+        for (int ny : { y - 1, y + 1 }) {
+            if (ny < 0 || ny >= fb.height) continue;
+            int nx = from;
+            while (nx <= to) {
+                nx = scanRight(fb, ny, nx, to, target, true);    // start of a run
+                if (nx > to) break;
+                stack.emplace_back(nx, ny);
+                nx = scanRight(fb, ny, nx, to, target, false);   // skip past it
+            }
+        }
+        peak = std::max(peak, stack.size());
+    }
+    if (maxStack) *maxStack = peak;
+    return filled;
+}
+
+// Reference: per-pixel stack fill (one push per neighbour)
+size_t floodFillPerPixel(Framebuffer& fb, int sx, int sy, unsigned char newValue, bool eightConnected) {
+    const unsigned char target = fb.get(sx, sy);
+    if (target == newValue) return 0;
+    std::vector<std::pair<int,int>> stack;
+    stack.emplace_back(sx, sy);
+    size_t filled = 0;
+    while (!stack.empty()) {
+        auto [x, y] = stack.back();
+        stack.pop_back();
+        if (x < 0 || x >= fb.width || y < 0 || y >= fb.height || fb.get(x, y) != target) continue;
+        fb.set(x, y, newValue);
+        ++filled;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+                if ((dx || dy) && (eightConnected || !dx || !dy)) stack.emplace_back(x + dx, y + dy);
+    }
+    return filled;
+}
+
+// Perfect maze (randomised DFS): 1-pixel corridors between 1-pixel walls (255)
+void buildMaze(Framebuffer& fb, unsigned seed) {
+    fb.clear(255);
+    std::mt19937 rng(seed);
+    int cw = (fb.width - 1) / 2, ch = (fb.height - 1) / 2;
+    std::vector<char> seen(size_t(cw) * ch, 0);
+    std::vector<std::pair<int,int>> path{{0, 0}};
+    seen[0] = 1;
+    fb.set(1, 1, 0);
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    while (!path.empty()) {
+        auto [cx, cy] = path.back();
+        int options[4], n = 0;
+        for (int d = 0; d < 4; ++d) {
+            int nx = cx + dirs[d][0], ny = cy + dirs[d][1];
+            if (nx >= 0 && nx < cw && ny >= 0 && ny < ch && !seen[size_t(ny) * cw + nx]) options[n++] = d;
+        }
+        if (n == 0) { path.pop_back(); continue; }
+        int d = options[rng() % n];
+        int nx = cx + dirs[d][0], ny = cy + dirs[d][1];
+        seen[size_t(ny) * cw + nx] = 1;
+        fb.set(2 * cx + 1 + dirs[d][0], 2 * cy + 1 + dirs[d][1], 0);   // knock down the wall
+        fb.set(2 * nx + 1, 2 * ny + 1, 0);
+        path.emplace_back(nx, ny);
+    }
+}
+
+// Maze and open-area fills: span stack (SIMD / scalar scans) vs per-pixel stack
+void benchmarkFloodFill() {
+    struct Scene { const char* name; bool maze; };
+    std::cout << "Flood fill 2048x2048 (ms):\n";
+    for (Scene sc : { Scene{"maze", true}, Scene{"open + outlines", false} }) {
+        Framebuffer base;
+        base.init(2048, 2048, FbLayout::RowMajor);
+        if (sc.maze) {
+            buildMaze(base, 11);
+        } else {
+            base.clear(0);
+            std::vector<std::pair<int,int>> outline;
+            for (int i = 0; i < 12; ++i) {   // closed boxes with a diagonal
+                int x0 = 100 + (i % 4) * 480, y0 = 120 + (i / 4) * 620, x1 = x0 + 380, y1 = y0 + 500;
+                bresenhamLine(x0, y0, x1, y0, outline);
+                bresenhamLine(x1, y0, x1, y1, outline);
+                bresenhamLine(x1, y1, x0, y1, outline);
+                bresenhamLine(x0, y1, x0, y0, outline);
+                bresenhamLine(x0, y0, x1, y1, outline);
+            }
+            for (const auto &p : outline) base.set(p.first, p.second, 255);
+        }
+        for (bool eight : { false, true }) {
+            auto timeFill = [&](auto&& fill) {
+                Framebuffer fb = base;
+                auto t0 = std::chrono::steady_clock::now();
+                size_t n = fill(fb);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                return std::make_pair(ms, n);
+            };
+            size_t peak = 0;
+            useSimdScan = true;
+            auto simd = timeFill([&](Framebuffer& fb) { return floodFill(fb, 1, 1, 128, eight, &peak); });
+            useSimdScan = false;
+            auto scalar = timeFill([&](Framebuffer& fb) { return floodFill(fb, 1, 1, 128, eight); });
+            useSimdScan = true;
+            auto perPixel = timeFill([&](Framebuffer& fb) { return floodFillPerPixel(fb, 1, 1, 128, eight); });
+            std::cout << "  " << sc.name << (eight ? ", 8-conn: " : ", 4-conn: ") << simd.second << " px, span simd "
+                      << simd.first << ", span scalar " << scalar.first << ", per-pixel " << perPixel.first
+                      << " (peak stack " << peak << " spans)\n";
+        }
+    }
+}
+
+// ---------------- Anti-aliased thick lines ----------------
+
+// Capsule around segment (x0, y0)-(x1, y1): pixel centers within rho of the segment
+struct Capsule {
+    float x0, y0, x1, y1;
+    float ux, uy, len;   // unit direction and length (len == 0: a disc)
+};
+
+Capsule makeCapsule(float x0, float y0, float x1, float y1) {
+    Capsule c{ x0, y0, x1, y1, 1.0f, 0.0f, 0.0f };
+    float dx = x1 - x0, dy = y1 - y0;
+    c.len = std::sqrt(dx * dx + dy * dy);
+    if (c.len > 0) { c.ux = dx / c.len; c.uy = dy / c.len; }
+    return c;
+}
+
+// Solve lo <= a*x + b <= hi for x, intersected into [xlo, xhi]
+inline void clipLinear(float a, float b, float lo, float hi, float& xlo, float& xhi) {
+    if (std::fabs(a) < 1e-6f) {
+        if (b < lo || b > hi) { xlo = 1; xhi = 0; }
+        return;
+    }
+    float p = (lo - b) / a, q = (hi - b) / a;
+    xlo = std::max(xlo, std::min(p, q));
+    xhi = std::min(xhi, std::max(p, q));
+}
+
+// x extent of row y inside the capsule of radius rho: the band along the
+// segment plus the two end discs (convex, so one interval). Empty when lo > hi.
+void capsuleRowExtent(const Capsule& c, float y, float rho, float& lo, float& hi) {
+    lo = 1e30f; hi = -1e30f;
+    if (c.len > 0) {
+        // along-segment coordinate s(x) and signed line distance d(x) are linear in x
+        float blo = -1e30f, bhi = 1e30f;
+        clipLinear(c.ux, (y - c.y0) * c.uy - c.x0 * c.ux, 0.0f, c.len, blo, bhi);
+        clipLinear(-c.uy, (y - c.y0) * c.ux + c.x0 * c.uy, -rho, rho, blo, bhi);
+        if (blo <= bhi) { lo = blo; hi = bhi; }
+    }
+    const float ex[2] = { c.x0, c.x1 }, ey[2] = { c.y0, c.y1 };
+    for (int i = 0; i < 2; ++i) {
+        float dy = y - ey[i];
+        if (dy * dy > rho * rho) continue;
+        float half = std::sqrt(rho * rho - dy * dy);
+        lo = std::min(lo, ex[i] - half);
+        hi = std::max(hi, ex[i] + half);
+    }
+}
+
+// Edge-band coverage of pixels [xa, xb] on row y: 1 - (d - (R - 0.5)) clamped,
+// d = distance to the segment. Along the row s(x) and the line distance are
+// linear; the end caps take the distance to the endpoint instead.
+void shadeCapsuleEdge(Framebuffer& fb, const Capsule& c, float R, int y, int xa, int xb) {
+    const float fy = float(y);
+    const float s0 = (xa - c.x0) * c.ux + (fy - c.y0) * c.uy;      // s at xa
+    const float d0 = -(xa - c.x0) * c.uy + (fy - c.y0) * c.ux;     // line distance at xa
+    int x = xa;
+#ifdef __SSE2__
+    if (useSimdScan) {
+        const __m128 lane = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), len = _mm_set1_ps(c.len);
+        const __m128 edge = _mm_set1_ps(R + 0.5f), absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 dy0 = _mm_set1_ps(fy - c.y0), dy1 = _mm_set1_ps(fy - c.y1);
+        for (; x + 3 <= xb; x += 4) {
+            __m128 i = _mm_add_ps(_mm_set1_ps(float(x - xa)), lane);
+            __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), lane);
+            __m128 sv = _mm_add_ps(_mm_set1_ps(s0), _mm_mul_ps(i, _mm_set1_ps(c.ux)));
+            __m128 dl = _mm_and_ps(absMask, _mm_sub_ps(_mm_set1_ps(d0), _mm_mul_ps(i, _mm_set1_ps(c.uy))));
+            __m128 dx0 = _mm_sub_ps(px, _mm_set1_ps(c.x0)), dx1 = _mm_sub_ps(px, _mm_set1_ps(c.x1));
+            __m128 cap0 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx0, dx0), _mm_mul_ps(dy0, dy0)));
+            __m128 cap1 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx1, dx1), _mm_mul_ps(dy1, dy1)));
+            __m128 before = _mm_cmplt_ps(sv, zero), after = _mm_cmpgt_ps(sv, len);
+            __m128 d = _mm_or_ps(_mm_and_ps(before, cap0), _mm_andnot_ps(before, dl));
+            d = _mm_or_ps(_mm_and_ps(after, cap1), _mm_andnot_ps(after, d));
+            __m128 cov = _mm_min_ps(one, _mm_max_ps(zero, _mm_sub_ps(edge, d)));
+            __m128i v = _mm_cvtps_epi32(_mm_mul_ps(cov, _mm_set1_ps(255.0f)));
+            alignas(16) int out[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(out), v);
+            for (int k = 0; k < 4; ++k) {
+                unsigned char& dst = fb.data[fb.offset(x + k, y)];
+                dst = std::max<unsigned char>(dst, (unsigned char)out[k]);
+            }
+        }
+    }
+#endif
+    for (; x <= xb; ++x) {
+        float i = float(x - xa);
+        float sv = s0 + i * c.ux;
+        float d = std::fabs(d0 - i * c.uy);
+        if (sv < 0) d = std::sqrt((x - c.x0) * (x - c.x0) + (fy - c.y0) * (fy - c.y0));
+        else if (sv > c.len) d = std::sqrt((x - c.x1) * (x - c.x1) + (fy - c.y1) * (fy - c.y1));
+        float cov = std::min(1.0f, std::max(0.0f, R + 0.5f - d));
+        unsigned char& dst = fb.data[fb.offset(x, y)];
+        dst = std::max<unsigned char>(dst, (unsigned char)std::lrint(cov * 255.0f));
+    }
+}
+
+// Thick line of width W as a capsule, written with max-blending. Each row is
+// clipped analytically: the span within R - 0.5 is solid-filled, and only the
+// 1-2 px bands out to R + 0.5 get per-pixel coverage. antialias == false
+// fills the pixels within R solid (same spans, no bands) for comparison.
+void drawThickLineAA(Framebuffer& fb, int x0, int y0, int x1, int y1, int W, bool antialias = true) {
+    const float R = std::max(1, W) * 0.5f;
+    Capsule c = makeCapsule(float(x0), float(y0), float(x1), float(y1));
+    const float outerR = antialias ? R + 0.5f : R;
+    const float innerR = antialias ? R - 0.5f : R;
+    int ya = std::max(0, (int)std::ceil(std::min(y0, y1) - outerR));
+    int yb = std::min(fb.height - 1, (int)std::floor(std::max(y0, y1) + outerR));
+    for (int y = ya; y <= yb; ++y) {
+        float olo, ohi, ilo, ihi;
+        capsuleRowExtent(c, float(y), outerR, olo, ohi);
+        int xa = std::max(0, (int)std::ceil(olo)), xb = std::min(fb.width - 1, (int)std::floor(ohi));
+        if (xa > xb) continue;
+        int ia = xb + 1, ib = xb;   // solid interior (empty by default)
+        if (innerR > 0) {
+            capsuleRowExtent(c, float(y), innerR, ilo, ihi);
+            if (ilo <= ihi) {
+                ia = std::max(xa, (int)std::ceil(ilo));
+                ib = std::min(xb, (int)std::floor(ihi));
+            }
+        }
+        if (ia <= ib) {
+            fillSpan(fb, y, ia, ib, 255);
+            if (antialias) {
+                if (xa < ia) shadeCapsuleEdge(fb, c, R, y, xa, ia - 1);
+                if (ib < xb) shadeCapsuleEdge(fb, c, R, y, ib + 1, xb);
+            }
+        } else if (antialias) {
+            shadeCapsuleEdge(fb, c, R, y, xa, xb);
+        }
+    }
+}
+
+// Render the startup line into the framebuffer in the current mode
+void renderLine() {
+    framebuffer.clear();
+    if (useAntialiasedLines) drawThickLineAA(framebuffer, lineX0, lineY0, lineX1, lineY1, lineWidth);
+    else rasterizeToFramebuffer(pixels, framebuffer);
+    if (showCurves) {
+        for (const auto &p : curvePixels)
+            if (p.first >= 0 && p.first < framebuffer.width && p.second >= 0 && p.second < framebuffer.height)
+                framebuffer.set(p.first, p.second, 255);
+    }
+}
+
+// Aliased stamping (buildThickLine) vs capsule spans, hard-edged and anti-aliased
+void benchmarkAntialiasedLines() {
+    Framebuffer fb;
+    fb.init(winWidth, winHeight, FbLayout::RowMajor);
+    std::vector<std::pair<int,int>> pts;
+    const int reps = 5;
+    std::cout << "Thick lines, 16 per frame (ms/frame):\n";
+    for (int W : { 3, 9, 15 }) {
+        auto timeIt = [&](auto&& fn) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < reps; ++rep) {
+                fb.clear();
+                for (int i = 0; i < 16; ++i) fn(20 + i * 50, 20, winWidth - 20 - i * 50, winHeight - 20);
+            }
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / reps;
+        };
+        double stamped = timeIt([&](int ax, int ay, int bx, int by) {
+            buildThickLine(ax, ay, bx, by, W, pts);
+            for (const auto &p : pts)
+                if (p.first >= 0 && p.first < fb.width && p.second >= 0 && p.second < fb.height)
+                    fb.set(p.first, p.second, 255);
+        });
+        double hard = timeIt([&](int ax, int ay, int bx, int by) { drawThickLineAA(fb, ax, ay, bx, by, W, false); });
+        double aa = timeIt([&](int ax, int ay, int bx, int by) { drawThickLineAA(fb, ax, ay, bx, by, W, true); });
+        std::cout << "  W=" << W << ": stamped " << stamped << ", capsule spans " << hard << ", anti-aliased " << aa << "\n";
+    }
+}
+
+// OpenGL display callback
+void display() {
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // detile at upload time and blit the software framebuffer
+    framebuffer.detile(uploadBuffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glRasterPos2i(0, 0);
+    glDrawPixels(framebuffer.width, framebuffer.height, GL_LUMINANCE, GL_UNSIGNED_BYTE, uploadBuffer.data());
+
+    glutSwapBuffers();
+}
+
+// Set up orthographic 2D projection matching window pixels
+void setupOrtho(int width, int height) {
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0.0, width, 0.0, height); // origin at bottom-left
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+// Self-checks and timings of the software rasterizers ('b' key)
+void runBenchmarks() {
+    benchmarkFramebufferLayouts();
+    checkLargeEllipses();
+    benchmarkEllipseVsCircle();
+    checkSectorClipping();
+    benchmarkSectors();
+    benchmarkBezierFlattening();
+    benchmarkFloodFill();
+    benchmarkAntialiasedLines();
+}
+
+void keyboard(unsigned char key, int, int) {
+    if (key == 'a' || key == 'A') {
+        useAntialiasedLines = !useAntialiasedLines;
+        renderLine();
+        glutPostRedisplay();
+    }
+    if (key == 'c' || key == 'C') {
+        showCurves = !showCurves;
+        if (showCurves && curvePixels.empty()) buildCurveStrokes();
+        renderLine();
+        glutPostRedisplay();
+    }
+    if (key == 'b' || key == 'B') {
+        runBenchmarks();
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "Bresenham Thick Line Drawing (GLUT)\n";
+    std::cout << "Window size: " << winWidth << " x " << winHeight << "\n";
+    std::cout << "Enter two endpoints (x0 y0 x1 y1) and desired integer line width W.\n";
+    std::cout << "Coordinates should be integers within window. Example: 50 50 700 500 7\n\n";
+
+    int x0, y0, x1, y1, W;
+    std::cout << "Enter x0 y0 x1 y1 W: ";
+    if (!(std::cin >> x0 >> y0 >> x1 >> y1 >> W)) {
+        std::cerr << "Invalid input. Exiting.\n";
+        return 0;
+    }
+
+    // clamp coords & ensure W >= 1
+    x0 = clamp(x0, 0, winWidth - 1);
+    x1 = clamp(x1, 0, winWidth - 1);
+    y0 = clamp(y0, 0, winHeight - 1);
+    y1 = clamp(y1, 0, winHeight - 1);
+    if (W < 1) W = 1;
+
+    // build the thick line pixel list
+    buildThickLine(x0, y0, x1, y1, W, pixels);
+
+    lineX0 = x0; lineY0 = y0; lineX1 = x1; lineY1 = y1; lineWidth = W;
+    framebuffer.init(winWidth, winHeight, fbLayout);
+    renderLine();
+    std::cout << "Framebuffer layout: " << layoutName(fbLayout) << "\n";
+    std::cout << "Press 'a' to toggle anti-aliased thick lines, 'c' to toggle Bezier curves,\n"
+                 "'b' to run the rasterizer checks and benchmarks.\n";
+
+    // init GLUT & create window
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
+    glutInitWindowSize(winWidth, winHeight);
+    glutInitWindowPosition(100, 100);
+    glutCreateWindow("Bresenham Thick Line Drawing");
+
+    // background black, drawing in white
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glColor3f(1.0f, 1.0f, 1.0f);
+
+    setupOrtho(winWidth, winHeight);
+
+    glutDisplayFunc(display);
+    glutKeyboardFunc(keyboard);
+    glutMainLoop();
+
+    return 0;
+}
@@ -1,270 +1,2132 @@
-// liang_barsky_clipping.cpp
-// Implements Liang-Barsky line clipping with OpenGL visualization
-// Compile:
-//   g++ liang_barsky_clipping.cpp -o liang_barsky -lGL -lGLU -lglut -std=c++17
-
-#include <GL/glut.h>
-#include <vector>
-#include <iostream>
-#include <algorithm>
-#include <iomanip>
-
-struct Point { double x, y; };
-struct Segment { Point a, b; };
-
-double xmin_w = -50, ymin_w = -50, xmax_w = 50, ymax_w = 50;
-std::vector<Segment> segments;    // original input segments
-std::vector<Segment> clipped;     // clipped segments (only those or visible parts)
-
-// viewport/window size for GLUT
-int winWidth = 800, winHeight = 800;
-
-// Liang-Barsky helper: clip a single param range
-bool liangBarskyClip(double x0, double y0, double x1, double y1,
-                     double xmin, double ymin, double xmax, double ymax,
-                     Point &out0, Point &out1)
-{
-    double dx = x1 - x0;
-    double dy = y1 - y0;
-
-    // p and q arrays for 4 inequalities
-    double p[4] = { -dx, dx, -dy, dy }; // left, right, bottom, top
-    double q[4] = { x0 - xmin, xmax - x0, y0 - ymin, ymax - y0 };
-
-    double u1 = 0.0; // max entering t
-    double u2 = 1.0; // min leaving t
-
-    for (int i = 0; i < 4; ++i) {
-        double pi = p[i];
-        double qi = q[i];
-        if (pi == 0) {
-            if (qi < 0) {
-                // Line parallel to edge and outside
-                return false;
-            }
-            // Line parallel and inside for this boundary -> continue
-        } else {
-            double t = qi / pi;
-            if (pi < 0) {
-                // potential entering
-                if (t > u1) u1 = t;
-            } else {
-                // potential leaving
-                if (t < u2) u2 = t;
-            }
-        }
-    }
-
-    if (u1 > u2) return false; // no visible segment
-
-    // compute clipped points
-    out0.x = x0 + u1 * dx;
-    out0.y = y0 + u1 * dy;
-    out1.x = x0 + u2 * dx;
-    out1.y = y0 + u2 * dy;
-    return true;
-}
-
-// A more robust Liang-Barsky variant using the standard p/q arrangement and handling q differences
-bool liangBarsky(double x0, double y0, double x1, double y1,
-                 double xmin, double ymin, double xmax, double ymax,
-                 Point &out0, Point &out1)
-{
-    double dx = x1 - x0;
-    double dy = y1 - y0;
-
-    double p[4] = { -dx, dx, -dy, dy };
-    double q[4] = { x0 - xmin, xmax - x0, y0 - ymin, ymax - y0 };
-
-    double umin = 0.0;
-    double umax = 1.0;
-
-    for (int i = 0; i < 4; ++i) {
-        if (p[i] == 0) {
-            if (q[i] < 0) {
-                return false; // parallel and outside
-            }
-            // parallel and inside -> no restriction
-        } else {
-            double t = q[i] / p[i];
-            if (p[i] < 0) {
-                // entering
-                if (t > umin) umin = t;
-            } else {
-                // leaving
-                if (t < umax) umax = t;
-            }
-        }
-    }
-
-    if (umin > umax) return false;
-
-    out0.x = x0 + umin * dx;
-    out0.y = y0 + umin * dy;
-    out1.x = x0 + umax * dx;
-    out1.y = y0 + umax * dy;
-    return true;
-}
-
-// Draw utility: draw a line segment with given width and color
-void drawLine(const Point &p1, const Point &p2, float width=2.0f)
-{
-    glLineWidth(width);
-    glBegin(GL_LINES);
-      glVertex2d(p1.x, p1.y);
-      glVertex2d(p2.x, p2.y);
-    glEnd();
-}
-
-// Display callback
-void display()
-{
-    glClear(GL_COLOR_BUFFER_BIT);
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-
-    // Draw clipping rectangle (blue)
-    glColor3f(0.0f, 0.0f, 1.0f);
-    glLineWidth(2.5f);
-    glBegin(GL_LINE_LOOP);
-      glVertex2d(xmin_w, ymin_w);
-      glVertex2d(xmax_w, ymin_w);
-      glVertex2d(xmax_w, ymax_w);
-      glVertex2d(xmin_w, ymax_w);
-    glEnd();
-
-    // Draw original lines in red (thin, partially transparent look using stipple)
-    glColor3f(0.8f, 0.1f, 0.1f); // red
-    glLineWidth(1.5f);
-    for (const auto &seg : segments) {
-        drawLine(seg.a, seg.b, 1.5f);
-    }
-
-    // Draw clipped segments in green (overlay)
-    glColor3f(0.05f, 0.6f, 0.05f); // green
-    glLineWidth(3.5f);
-    for (const auto &c : clipped) {
-        drawLine(c.a, c.b, 3.5f);
-    }
-
-    // Optional: draw endpoints of clipped segments as small points
-    glPointSize(6.0f);
-    glBegin(GL_POINTS);
-    for (const auto &c : clipped) {
-        glVertex2d(c.a.x, c.a.y);
-        glVertex2d(c.b.x, c.b.y);
-    }
-    glEnd();
-
-    glutSwapBuffers();
-}
-
-// Reshape callback - set orthographic projection to cover the clipping window nicely
-void reshape(int w, int h)
-{
-    winWidth = w; winHeight = h;
-    glViewport(0, 0, w, h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-
-    // compute a small margin around the clipping rectangle so we can see everything
-    double width = xmax_w - xmin_w;
-    double height = ymax_w - ymin_w;
-    double marginX = std::max(10.0, width * 0.15);
-    double marginY = std::max(10.0, height * 0.15);
-
-    double left = xmin_w - marginX;
-    double right = xmax_w + marginX;
-    double bottom = ymin_w - marginY;
-    double top = ymax_w + marginY;
-
-    // keep aspect ratio by expanding whichever dimension is smaller
-    double aspectWindow = (right - left) / (top - bottom);
-    double aspectViewport = double(w) / double(h);
-    if (aspectViewport > aspectWindow) {
-        // viewport wider -> expand x-range
-        double extra = ((top - bottom) * aspectViewport - (right - left)) * 0.5;
-        left -= extra; right += extra;
-    } else {
-        double extra = ((right - left) / aspectViewport - (top - bottom)) * 0.5;
-        bottom -= extra; top += extra;
-    }
-
-    gluOrtho2D(left, right, bottom, top);
-}
-
-// Keyboard: press ESC or q to quit
-void keyboard(unsigned char key, int x, int y)
-{
-    if (key == 27 || key == 'q' || key == 'Q') {
-        exit(0);
-    }
-}
-
-// Prepare clipping for all input segments
-void computeClipped()
-{
-    clipped.clear();
-    for (const auto &s : segments) {
-        Point outA, outB;
-        // Use liangBarsky (robust version). If visible, push the clipped part.
-        if (liangBarsky(s.a.x, s.a.y, s.b.x, s.b.y, xmin_w, ymin_w, xmax_w, ymax_w, outA, outB)) {
-            // If degenerate (zero-length) or extremely small, we still add it
-            clipped.push_back({outA, outB});
-        }
-    }
-}
-
-int main(int argc, char** argv)
-{
-    std::cout << std::fixed << std::setprecision(3);
-    std::cout << "Liang-Barsky Line Clipping Visualization\n";
-    std::cout << "Enter clipping rectangle xmin ymin xmax ymax (space-separated):\n";
-    if (!(std::cin >> xmin_w >> ymin_w >> xmax_w >> ymax_w)) {
-        std::cerr << "Invalid clipping window input. Exiting.\n";
-        return 1;
-    }
-
-    if (xmin_w > xmax_w) std::swap(xmin_w, xmax_w);
-    if (ymin_w > ymax_w) std::swap(ymin_w, ymax_w);
-
-    int n;
-    std::cout << "Enter number of line segments: ";
-    if (!(std::cin >> n) || n < 0) {
-        std::cerr << "Invalid number of segments. Exiting.\n";
-        return 1;
-    }
-
-    segments.clear();
-    std::cout << "Enter each segment as: x0 y0 x1 y1 (space-separated), one per line.\n";
-    for (int i = 0; i < n; ++i) {
-        double x0, y0, x1, y1;
-        if (!(std::cin >> x0 >> y0 >> x1 >> y1)) {
-            std::cerr << "Invalid segment input; expected 4 numbers. Exiting.\n";
-            return 1;
-        }
-        segments.push_back({{x0,y0},{x1,y1}});
-    }
-
-    // Precompute clipped portions
-    computeClipped();
-
-    // Initialize GLUT and run main loop
-    glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
-    glutInitWindowSize(winWidth, winHeight);
-    glutCreateWindow("Liang-Barsky Line Clipping");
-
-    // background white
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-
-    // callbacks
-    glutDisplayFunc(display);
-    glutReshapeFunc(reshape);
-    glutKeyboardFunc(keyboard);
-
-    std::cout << "Press ESC or 'q' to quit the visualization window.\n";
-
-    glutMainLoop();
-    return 0;
-}
+// liang_barsky_clipping.cpp
+// Implements Liang-Barsky line clipping with OpenGL visualization
+// Compile:
+//   g++ liang_barsky_clipping.cpp -o liang_barsky -lGL -lGLU -lglut -std=c++17 -pthread
+// Add -DENABLE_INSTRUMENTATION for clip counters and timers (instrumentation.h).
+
+#include "glshader.h"
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include <queue>
+#include <atomic>
+#include <limits>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <tuple>
+#include <cstdlib>
+#include <cstring>
+
+#include "instrumentation.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HAVE_MMAP 1
+#endif
+
+struct Point { double x, y; };
+struct Segment { Point a, b; };
+
+// Segments stored as separate coordinate columns (structure of arrays)
+struct SegmentColumns {
+    std::vector<double> x0, y0, x1, y1;
+    size_t size() const { return x0.size(); }
+    void resize(size_t n) { x0.resize(n); y0.resize(n); x1.resize(n); y1.resize(n); }
+};
+
+// Homogeneous clip-space segments (x, y, z, w per endpoint) as columns
+struct HomogeneousColumns {
+    std::vector<double> x0, y0, z0, w0, x1, y1, z1, w1;
+    size_t size() const { return x0.size(); }
+    void clear() {
+        for (auto *v : { &x0, &y0, &z0, &w0, &x1, &y1, &z1, &w1 }) v->clear();
+    }
+
+    void push(double ax, double ay, double az, double aw, double bx, double by, double bz, double bw) {
+        x0.push_back(ax); y0.push_back(ay); z0.push_back(az); w0.push_back(aw);
+        x1.push_back(bx); y1.push_back(by); z1.push_back(bz); w1.push_back(bw);
+    }
+};
+
+// Lazy clip result: a visible part of source segment `index` is fully described
+// by its parameter interval [u1, u2] along the source segment
+struct ClipRef { uint32_t index; float u1, u2; };
+
+// Compact clipping output. Segments that are entirely visible only set a bit;
+// straddling ones keep a ClipRef. Endpoints are materialized on demand.
+struct ClipResult {
+    std::vector<uint64_t> whole;   // bit i set: source segment i is visible unchanged
+    std::vector<ClipRef> partial;  // clipped segments, ascending source index
+    size_t wholeCount = 0;
+
+    size_t count() const { return wholeCount + partial.size(); }
+    size_t bytes() const { return whole.size() * sizeof(uint64_t) + partial.size() * sizeof(ClipRef); }
+};
+
+// Clipped pieces bucketed per tile of a uniform nx x ny grid of windows
+struct TileBins {
+    int nx = 0, ny = 0;
+    std::vector<std::vector<Segment>> bins; // index ty * nx + tx
+};
+
+// 2x3 affine transform: x' = m00*x + m01*y + tx, y' = m10*x + m11*y + ty
+struct Affine2D {
+    double m00 = 1, m01 = 0, tx = 0;
+    double m10 = 0, m11 = 1, ty = 0;
+};
+
+double xmin_w = -50, ymin_w = -50, xmax_w = 50, ymax_w = 50;
+std::vector<Segment> segments;    // original input segments
+std::vector<std::vector<Point>> polylines; // input segments chained into polylines (input order)
+std::vector<Segment> simplified;  // polylines after view-dependent simplification (world space)
+SegmentColumns simplifiedCols;    // same segments as columns (clipper input)
+Affine2D viewTransform;           // world -> clip space (pan/zoom/rotate of the data)
+ClipResult clipped;               // visible parts of simplifiedCols (lazy, see ClipResult)
+std::vector<Segment> decimated;   // clipped segments snapped to pixels and merged (what gets drawn)
+
+// 3D wireframe overlay (toggled with 'w'): a CAD-like scene in clip space is
+// frustum-clipped once and projected into the clipping window on view updates
+bool showWireframe = false;
+HomogeneousColumns wireframe;            // clip-space edges of the scene
+HomogeneousColumns wireframeClipped;     // visible parts after the frustum clip
+std::vector<Segment> wireframeProjected; // wireframeClipped mapped to world space
+
+// viewport/window size for GLUT
+int winWidth = 800, winHeight = 800;
+
+// Sort segments along a Hilbert curve (by midpoint) before clipping so that
+// consecutive segments touch nearby parts of the framebuffer
+bool useSpatialSort = true;
+
+// Remove duplicate segments and merge overlapping collinear ones before anything
+// else runs (exported meshes draw shared edges twice). Endpoints closer than
+// dedupeQuantum world units are treated as equal.
+bool useDedupe = true;
+double dedupeQuantum = 1e-6;
+
+// Print pipeline statistics on every view update (toggled with 'v')
+bool verboseView = false;
+
+// Current world-space view rectangle (set in reshape)
+double viewLeft = -100, viewRight = 100, viewBottom = -100, viewTop = 100;
+
+// Polyline simplification tolerance in screen pixels (0 disables simplification)
+double simplifyTolerancePx = 0.5;
+
+// Multi-resolution (LOD) pyramid of the input, stored in tiles in a file that is
+// memory-mapped for viewing. Level 0 holds the original segments; level k > 0 is
+// simplified with a tolerance of baseTolerance * 2^(k-1) world units. Each level
+// is split into a LOD_GRID x LOD_GRID grid of tiles over the data bounds.
+// Opt-in: set CLIP_LOD_FILE to the pyramid path. A valid existing file is mapped
+// as is and the segment input is not read; the file is built from the input only
+// when it is missing or invalid, or when CLIP_LOD_REBUILD=1.
+bool useLodPyramid = false;
+const char* lodFilePath = nullptr;
+const int LOD_LEVELS = 12;
+const int LOD_GRID = 16;
+
+struct LodHeader {
+    uint32_t magic, levels, grid, reserved;
+    double minX, minY, maxX, maxY;
+    double baseTolerance;
+};
+struct LodTile {
+    uint64_t first;   // index of first segment in the segment array
+    uint64_t count;
+    double minX, minY, maxX, maxY; // bounds of the segments stored in the tile
+};
+const uint32_t LOD_MAGIC = 0x31444f4c; // "LOD1"
+
+// Simplification tolerance of pyramid level k (level 0 is exact)
+inline double lodLevelTolerance(const LodHeader &hdr, int k)
+{
+    return k == 0 ? 0.0 : hdr.baseTolerance * double(1u << (k - 1));
+}
+
+const unsigned char* lodData = nullptr; // mapped file contents
+size_t lodSize = 0;
+size_t lodSegmentCount = 0;             // segments stored after the tile table
+std::vector<unsigned char> lodFallback; // used when mmap is unavailable
+
+// Draw clipped segments as instanced quads from a single instance buffer (one
+// draw call, any width) instead of immediate-mode GL_LINES with glLineWidth,
+// which many drivers cap at 1px. Falls back automatically when GL < 3.3.
+bool useInstancedRendering = true;
+bool instancedReady = false;
+bool instancesDirty = true;
+
+// Rebuilds everything that depends on the view (defined after the clipping code)
+void updateView();
+// Times the clipping kernels on synthetic data (defined after the clipping code)
+void runBenchmarks();
+
+// Liang-Barsky helper: clip a single param range
+bool liangBarskyClip(double x0, double y0, double x1, double y1,
+                     double xmin, double ymin, double xmax, double ymax,
+                     Point &out0, Point &out1)
+{
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+
+    // p and q arrays for 4 inequalities
+    double p[4] = { -dx, dx, -dy, dy }; // left, right, bottom, top
+    double q[4] = { x0 - xmin, xmax - x0, y0 - ymin, ymax - y0 };
+
+    double u1 = 0.0; // max entering t
+    double u2 = 1.0; // min leaving t
+
+    for (int i = 0; i < 4; ++i) {
+        double pi = p[i];
+        double qi = q[i];
+        if (pi == 0) {
+            if (qi < 0) {
+                // Line parallel to edge and outside
+                return false;
+            }
+            // Line parallel and inside for this boundary -> continue
+        } else {
+            double t = qi / pi;
+            if (pi < 0) {
+                // potential entering
+                if (t > u1) u1 = t;
+            } else {
+                // potential leaving
+                if (t < u2) u2 = t;
+            }
+        }
+    }
+
+    if (u1 > u2) return false; // no visible segment
+
+    // compute clipped points
+    out0.x = x0 + u1 * dx;
+    out0.y = y0 + u1 * dy;
+    out1.x = x0 + u2 * dx;
+    out1.y = y0 + u2 * dy;
+    return true;
+}
+
+// Liang-Barsky returning the visible parameter interval instead of endpoints
+bool liangBarskyParams(double x0, double y0, double x1, double y1,
+                       double xmin, double ymin, double xmax, double ymax,
+                       double &umin, double &umax)
+{
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x0 - xmin, xmax - x0, y0 - ymin, ymax - y0 };
+
+    umin = 0.0;
+    umax = 1.0;
+
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false; // parallel and outside
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0) { if (t > umin) umin = t; } // entering
+            else          { if (t < umax) umax = t; } // leaving
+        }
+    }
+    return umin <= umax;
+}
+
+// A more robust Liang-Barsky variant using the standard p/q arrangement and handling q differences
+bool liangBarsky(double x0, double y0, double x1, double y1,
+                 double xmin, double ymin, double xmax, double ymax,
+                 Point &out0, Point &out1)
+{
+    double umin, umax;
+    if (!liangBarskyParams(x0, y0, x1, y1, xmin, ymin, xmax, ymax, umin, umax)) return false;
+
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    out0.x = x0 + umin * dx;
+    out0.y = y0 + umin * dy;
+    out1.x = x0 + umax * dx;
+    out1.y = y0 + umax * dy;
+    return true;
+}
+
+inline int clamp(int v, int lo, int hi) { return (v < lo) ? lo : (v > hi) ? hi : v; }
+
+// Early classification shared by the 2D and homogeneous clippers: each endpoint
+// gets an outcode (one bit per violated boundary); both zero -> fully inside,
+// a common bit -> fully outside one boundary, otherwise the segment straddles.
+enum ClipClass { CLIP_ACCEPT, CLIP_REJECT, CLIP_STRADDLE };
+
+inline ClipClass classifyOutcodes(unsigned c0, unsigned c1)
+{
+    if ((c0 | c1) == 0) return CLIP_ACCEPT;
+    if (c0 & c1) return CLIP_REJECT;
+    return CLIP_STRADDLE;
+}
+
+inline unsigned outcode2D(double x, double y, double xmin, double ymin, double xmax, double ymax)
+{
+    return (x < xmin ? 1u : 0u) | (x > xmax ? 2u : 0u) | (y < ymin ? 4u : 0u) | (y > ymax ? 8u : 0u);
+}
+
+// Clip-space frustum -w <= x, y, z <= w
+inline unsigned outcodeHomogeneous(double x, double y, double z, double w)
+{
+    return (x < -w ? 1u : 0u) | (x > w ? 2u : 0u) | (y < -w ? 4u : 0u)
+         | (y > w ? 8u : 0u) | (z < -w ? 16u : 0u) | (z > w ? 32u : 0u);
+}
+
+// Homogeneous Liang-Barsky against the 6 frustum planes. Each plane is a signed
+// distance d = w +/- coord that is linear in t, so all six go through the same
+// entering / leaving update. Returns false when nothing is visible.
+inline bool liangBarskyHomogeneous(double x0, double y0, double z0, double w0,
+                                   double x1, double y1, double z1, double w1,
+                                   double &u1, double &u2)
+{
+    const double d0[6] = { w0 + x0, w0 - x0, w0 + y0, w0 - y0, w0 + z0, w0 - z0 };
+    const double d1[6] = { w1 + x1, w1 - x1, w1 + y1, w1 - y1, w1 + z1, w1 - z1 };
+    u1 = 0.0;
+    u2 = 1.0;
+    bool outside = false;
+    for (int i = 0; i < 6; ++i) {
+        double denom = d0[i] - d1[i];
+        double t = (denom != 0.0) ? d0[i] / denom : 0.0;
+        outside |= (d0[i] < 0.0) & (d1[i] < 0.0);
+        u1 = (d0[i] < 0.0) ? std::max(u1, t) : u1;   // entering this plane
+        u2 = (d1[i] < 0.0) ? std::min(u2, t) : u2;   // leaving this plane
+    }
+    return !outside && u1 <= u2;
+}
+
+// Apply an affine transform to a point
+inline Point transformPoint(const Affine2D &m, double x, double y)
+{
+    return { m.m00 * x + m.m01 * y + m.tx, m.m10 * x + m.m11 * y + m.ty };
+}
+
+// Composition: apply b first, then a
+Affine2D compose(const Affine2D &a, const Affine2D &b)
+{
+    Affine2D r;
+    r.m00 = a.m00 * b.m00 + a.m01 * b.m10;  r.m01 = a.m00 * b.m01 + a.m01 * b.m11;
+    r.m10 = a.m10 * b.m00 + a.m11 * b.m10;  r.m11 = a.m10 * b.m01 + a.m11 * b.m11;
+    r.tx = a.m00 * b.tx + a.m01 * b.ty + a.tx;
+    r.ty = a.m10 * b.tx + a.m11 * b.ty + a.ty;
+    return r;
+}
+
+Affine2D inverse(const Affine2D &m)
+{
+    double det = m.m00 * m.m11 - m.m01 * m.m10;
+    Affine2D r;
+    r.m00 =  m.m11 / det;  r.m01 = -m.m01 / det;
+    r.m10 = -m.m10 / det;  r.m11 =  m.m00 / det;
+    r.tx = -(r.m00 * m.tx + r.m01 * m.ty);
+    r.ty = -(r.m10 * m.tx + r.m11 * m.ty);
+    return r;
+}
+
+// No rotation or shear: an axis-aligned window maps to an axis-aligned window
+inline bool isAxisAligned(const Affine2D &m)
+{
+    return m.m01 == 0.0 && m.m10 == 0.0 && m.m00 != 0.0 && m.m11 != 0.0;
+}
+
+void toColumns(const std::vector<Segment> &segs, SegmentColumns &cols)
+{
+    cols.resize(segs.size());
+    for (size_t i = 0; i < segs.size(); ++i) {
+        cols.x0[i] = segs[i].a.x; cols.y0[i] = segs[i].a.y;
+        cols.x1[i] = segs[i].b.x; cols.y1[i] = segs[i].b.y;
+    }
+}
+
+// Fused kernel: transform each segment and clip it in the same pass, with no
+// intermediate transformed array
+void clipColumnsFused(const SegmentColumns &c, const Affine2D &m,
+                      double xmin, double ymin, double xmax, double ymax,
+                      std::vector<Segment> &out)
+{
+    const size_t n = c.size();
+    for (size_t i = 0; i < n; ++i) {
+        double x0 = m.m00 * c.x0[i] + m.m01 * c.y0[i] + m.tx;
+        double y0 = m.m10 * c.x0[i] + m.m11 * c.y0[i] + m.ty;
+        double x1 = m.m00 * c.x1[i] + m.m01 * c.y1[i] + m.tx;
+        double y1 = m.m10 * c.x1[i] + m.m11 * c.y1[i] + m.ty;
+        ClipClass cls = classifyOutcodes(outcode2D(x0, y0, xmin, ymin, xmax, ymax),
+                                         outcode2D(x1, y1, xmin, ymin, xmax, ymax));
+        if (cls == CLIP_REJECT) continue;
+        if (cls == CLIP_ACCEPT) { out.push_back({ {x0, y0}, {x1, y1} }); continue; }
+        Point outA, outB;
+        if (liangBarsky(x0, y0, x1, y1, xmin, ymin, xmax, ymax, outA, outB))
+            out.push_back({outA, outB});
+    }
+}
+
+// Two-pass reference: transform all columns into a temporary, then clip
+void clipColumnsTwoPass(const SegmentColumns &c, const Affine2D &m,
+                        double xmin, double ymin, double xmax, double ymax,
+                        SegmentColumns &tmp, std::vector<Segment> &out)
+{
+    const size_t n = c.size();
+    tmp.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        tmp.x0[i] = m.m00 * c.x0[i] + m.m01 * c.y0[i] + m.tx;
+        tmp.y0[i] = m.m10 * c.x0[i] + m.m11 * c.y0[i] + m.ty;
+        tmp.x1[i] = m.m00 * c.x1[i] + m.m01 * c.y1[i] + m.tx;
+        tmp.y1[i] = m.m10 * c.x1[i] + m.m11 * c.y1[i] + m.ty;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Point outA, outB;
+        if (liangBarsky(tmp.x0[i], tmp.y0[i], tmp.x1[i], tmp.y1[i], xmin, ymin, xmax, ymax, outA, outB))
+            out.push_back({outA, outB});
+    }
+}
+
+// Axis-aligned transforms only: map the window back to world space, clip the
+// untransformed segments and transform just the survivors
+void clipColumnsInverseWindow(const SegmentColumns &c, const Affine2D &m,
+                              double xmin, double ymin, double xmax, double ymax,
+                              std::vector<Segment> &out)
+{
+    double wx0 = (xmin - m.tx) / m.m00, wx1 = (xmax - m.tx) / m.m00;
+    double wy0 = (ymin - m.ty) / m.m11, wy1 = (ymax - m.ty) / m.m11;
+    if (wx0 > wx1) std::swap(wx0, wx1);
+    if (wy0 > wy1) std::swap(wy0, wy1);
+
+    const size_t n = c.size();
+    for (size_t i = 0; i < n; ++i) {
+        ClipClass cls = classifyOutcodes(outcode2D(c.x0[i], c.y0[i], wx0, wy0, wx1, wy1),
+                                         outcode2D(c.x1[i], c.y1[i], wx0, wy0, wx1, wy1));
+        if (cls == CLIP_REJECT) continue;
+        Point outA{ c.x0[i], c.y0[i] }, outB{ c.x1[i], c.y1[i] };
+        if (cls == CLIP_STRADDLE &&
+            !liangBarsky(c.x0[i], c.y0[i], c.x1[i], c.y1[i], wx0, wy0, wx1, wy1, outA, outB)) continue;
+        out.push_back({ transformPoint(m, outA.x, outA.y), transformPoint(m, outB.x, outB.y) });
+    }
+}
+
+// ---------------- Runtime CPU feature dispatch ----------------
+// The batch classification kernel is written once with GCC vector extensions
+// (N lanes of double) and compiled per target with target attributes. At startup
+// the CPU is queried once (cpuid via __builtin_cpu_supports) and the best variant
+// is bound to a function pointer. CLIP_SIMD_LEVEL=generic|sse4.2|avx2|avx512
+// forces a lower level for testing and benchmarking. The vector extensions and
+// target attributes are GCC/Clang only; other compilers build just the scalar
+// generic kernel.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_CPU_DISPATCH 1
+#endif
+
+// The per-target variants only vectorize if the body is inlined into them
+#if defined(__GNUC__)
+#define CLIP_ALWAYS_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define CLIP_ALWAYS_INLINE __forceinline
+#else
+#define CLIP_ALWAYS_INLINE inline
+#endif
+
+enum class SimdLevel { Generic, SSE42, AVX2, AVX512 };
+
+const char *simdLevelName(SimdLevel l)
+{
+    switch (l) {
+        case SimdLevel::SSE42:  return "sse4.2";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default:                return "generic";
+    }
+}
+
+#ifdef HAVE_CPU_DISPATCH
+// N-lane vectors (a class template so the vector size can depend on N)
+template <int N> struct SimdLanes {
+    typedef double D __attribute__((vector_size(N * sizeof(double))));
+    typedef long long L __attribute__((vector_size(N * sizeof(long long))));
+};
+#endif
+
+// Transform segments [begin, end) by m and store their ClipClass in cls[i - begin].
+// Branch-free so every lane runs the same instructions; the scalar tail matches
+// outcode2D / classifyOutcodes exactly.
+template <int N>
+static CLIP_ALWAYS_INLINE
+void classifySegmentsBody(const SegmentColumns &c, size_t begin, size_t end, const Affine2D &m,
+                          double xmin, double ymin, double xmax, double ymax, uint8_t *cls)
+{
+    size_t i = begin;
+#ifdef HAVE_CPU_DISPATCH
+    typedef typename SimdLanes<N>::D VD;
+    typedef typename SimdLanes<N>::L VL;
+    for (; i + N <= end; i += N) {
+        VD ax, ay, bx, by;
+        std::memcpy(&ax, &c.x0[i], sizeof(VD));
+        std::memcpy(&ay, &c.y0[i], sizeof(VD));
+        std::memcpy(&bx, &c.x1[i], sizeof(VD));
+        std::memcpy(&by, &c.y1[i], sizeof(VD));
+        VD x0 = m.m00 * ax + m.m01 * ay + m.tx, y0 = m.m10 * ax + m.m11 * ay + m.ty;
+        VD x1 = m.m00 * bx + m.m01 * by + m.tx, y1 = m.m10 * bx + m.m11 * by + m.ty;
+        VL c0 = ((x0 < xmin) & 1) | ((x0 > xmax) & 2) | ((y0 < ymin) & 4) | ((y0 > ymax) & 8);
+        VL c1 = ((x1 < xmin) & 1) | ((x1 > xmax) & 2) | ((y1 < ymin) & 4) | ((y1 > ymax) & 8);
+        // accept (0) when no bits, reject (1) on a common bit, else straddle (2)
+        VL k = ((c0 | c1) != 0) & (((c0 & c1) != 0) + 2);
+        for (int l = 0; l < N; ++l) cls[i - begin + l] = static_cast<uint8_t>(k[l]);
+    }
+#endif
+    for (; i < end; ++i) {
+        Point a = transformPoint(m, c.x0[i], c.y0[i]), b = transformPoint(m, c.x1[i], c.y1[i]);
+        cls[i - begin] = static_cast<uint8_t>(classifyOutcodes(outcode2D(a.x, a.y, xmin, ymin, xmax, ymax),
+                                                               outcode2D(b.x, b.y, xmin, ymin, xmax, ymax)));
+    }
+}
+
+// Frustum-clip clip-space segments [begin, end): cls[i - begin] gets the outcode
+// class and u1/u2 the visible interval of straddling segments (u1 > u2 when
+// nothing is visible). The outcodes are computed for every segment; only the
+// straddling ones are gathered into local columns for the six-plane pass. The
+// scalar tails match outcodeHomogeneous / liangBarskyHomogeneous exactly.
+const size_t FRUSTUM_GATHER = 256;
+
+template <int N>
+static CLIP_ALWAYS_INLINE
+void clipHomogeneousBody(const HomogeneousColumns &c, size_t begin, size_t end,
+                         uint8_t *cls, double *u1, double *u2)
+{
+    size_t i = begin;
+#ifdef HAVE_CPU_DISPATCH
+    typedef typename SimdLanes<N>::D VD;
+    typedef typename SimdLanes<N>::L VL;
+    for (; i + N <= end; i += N) {
+        VD x0, y0, z0, w0, x1, y1, z1, w1;
+        std::memcpy(&x0, &c.x0[i], sizeof(VD));
+        std::memcpy(&y0, &c.y0[i], sizeof(VD));
+        std::memcpy(&z0, &c.z0[i], sizeof(VD));
+        std::memcpy(&w0, &c.w0[i], sizeof(VD));
+        std::memcpy(&x1, &c.x1[i], sizeof(VD));
+        std::memcpy(&y1, &c.y1[i], sizeof(VD));
+        std::memcpy(&z1, &c.z1[i], sizeof(VD));
+        std::memcpy(&w1, &c.w1[i], sizeof(VD));
+        VL c0 = ((x0 < -w0) & 1) | ((x0 > w0) & 2) | ((y0 < -w0) & 4) | ((y0 > w0) & 8)
+              | ((z0 < -w0) & 16) | ((z0 > w0) & 32);
+        VL c1 = ((x1 < -w1) & 1) | ((x1 > w1) & 2) | ((y1 < -w1) & 4) | ((y1 > w1) & 8)
+              | ((z1 < -w1) & 16) | ((z1 > w1) & 32);
+        VL k = ((c0 | c1) != 0) & (((c0 & c1) != 0) + 2);
+        for (int l = 0; l < N; ++l) cls[i - begin + l] = static_cast<uint8_t>(k[l]);
+    }
+#endif
+    for (; i < end; ++i)
+        cls[i - begin] = static_cast<uint8_t>(classifyOutcodes(outcodeHomogeneous(c.x0[i], c.y0[i], c.z0[i], c.w0[i]),
+                                                               outcodeHomogeneous(c.x1[i], c.y1[i], c.z1[i], c.w1[i])));
+
+    for (size_t b = begin; b < end; b += FRUSTUM_GATHER) {
+        const size_t e = std::min(end, b + FRUSTUM_GATHER);
+        // plane distances d = w + coord / w - coord of both endpoints, straddlers only
+        double d0[6][FRUSTUM_GATHER], d1[6][FRUSTUM_GATHER];
+        uint32_t at[FRUSTUM_GATHER];
+        size_t m = 0;
+        for (size_t j = b; j < e; ++j) {
+            if (cls[j - begin] != CLIP_STRADDLE) continue;
+            at[m] = static_cast<uint32_t>(j - begin);
+            d0[0][m] = c.w0[j] + c.x0[j]; d0[1][m] = c.w0[j] - c.x0[j];
+            d0[2][m] = c.w0[j] + c.y0[j]; d0[3][m] = c.w0[j] - c.y0[j];
+            d0[4][m] = c.w0[j] + c.z0[j]; d0[5][m] = c.w0[j] - c.z0[j];
+            d1[0][m] = c.w1[j] + c.x1[j]; d1[1][m] = c.w1[j] - c.x1[j];
+            d1[2][m] = c.w1[j] + c.y1[j]; d1[3][m] = c.w1[j] - c.y1[j];
+            d1[4][m] = c.w1[j] + c.z1[j]; d1[5][m] = c.w1[j] - c.z1[j];
+            ++m;
+        }
+        size_t k = 0;
+#ifdef HAVE_CPU_DISPATCH
+        const VD zero = {};
+        for (; k + N <= m; k += N) {
+            VD lo = zero, hi = zero + 1.0;
+            VL outside = {};
+            for (int p = 0; p < 6; ++p) {
+                VD a, z;
+                std::memcpy(&a, &d0[p][k], sizeof(VD));
+                std::memcpy(&z, &d1[p][k], sizeof(VD));
+                VD denom = a - z;
+                VD t = (denom != 0.0) ? a / denom : zero;
+                outside |= (a < 0.0) & (z < 0.0);
+                lo = ((a < 0.0) & (lo < t)) ? t : lo;   // entering this plane
+                hi = ((z < 0.0) & (t < hi)) ? t : hi;   // leaving this plane
+            }
+            VL hidden = outside | (lo > hi);
+            lo = hidden ? zero + 1.0 : lo;
+            hi = hidden ? zero : hi;
+            for (int l = 0; l < N; ++l) {
+                u1[at[k + l]] = lo[l];
+                u2[at[k + l]] = hi[l];
+            }
+        }
+#endif
+        for (; k < m; ++k) {
+            double lo = 0.0, hi = 1.0;
+            bool outside = false;
+            for (int p = 0; p < 6; ++p) {
+                double denom = d0[p][k] - d1[p][k];
+                double t = (denom != 0.0) ? d0[p][k] / denom : 0.0;
+                outside |= (d0[p][k] < 0.0) & (d1[p][k] < 0.0);
+                lo = (d0[p][k] < 0.0) ? std::max(lo, t) : lo;
+                hi = (d1[p][k] < 0.0) ? std::min(hi, t) : hi;
+            }
+            if (outside || lo > hi) { lo = 1.0; hi = 0.0; }
+            u1[at[k]] = lo;
+            u2[at[k]] = hi;
+        }
+    }
+}
+
+typedef void (*ClassifySegmentsFn)(const SegmentColumns &, size_t, size_t, const Affine2D &,
+                                   double, double, double, double, uint8_t *);
+
+#define CLASSIFY_VARIANT(name, lanes, ...)                                                        \
+    __VA_ARGS__ void name(const SegmentColumns &c, size_t begin, size_t end, const Affine2D &m,  \
+                          double xmin, double ymin, double xmax, double ymax, uint8_t *cls)      \
+    { classifySegmentsBody<lanes>(c, begin, end, m, xmin, ymin, xmax, ymax, cls); }
+
+CLASSIFY_VARIANT(classifySegmentsGeneric, 2)
+#ifdef HAVE_CPU_DISPATCH
+CLASSIFY_VARIANT(classifySegmentsSSE42, 2, __attribute__((target("sse4.2"))))
+CLASSIFY_VARIANT(classifySegmentsAVX2, 4, __attribute__((target("avx2"))))
+CLASSIFY_VARIANT(classifySegmentsAVX512, 8, __attribute__((target("avx512f"))))
+#endif
+#undef CLASSIFY_VARIANT
+
+typedef void (*ClipHomogeneousFn)(const HomogeneousColumns &, size_t, size_t, uint8_t *, double *, double *);
+
+#define FRUSTUM_VARIANT(name, lanes, ...)                                                         \
+    __VA_ARGS__ void name(const HomogeneousColumns &c, size_t begin, size_t end,                 \
+                          uint8_t *cls, double *u1, double *u2)                                  \
+    { clipHomogeneousBody<lanes>(c, begin, end, cls, u1, u2); }
+
+FRUSTUM_VARIANT(clipHomogeneousGeneric, 2)
+#ifdef HAVE_CPU_DISPATCH
+FRUSTUM_VARIANT(clipHomogeneousSSE42, 2, __attribute__((target("sse4.2"))))
+FRUSTUM_VARIANT(clipHomogeneousAVX2, 4, __attribute__((target("avx2"))))
+FRUSTUM_VARIANT(clipHomogeneousAVX512, 8, __attribute__((target("avx512f"))))
+#endif
+#undef FRUSTUM_VARIANT
+
+SimdLevel simdLevel = SimdLevel::Generic;       // bound level
+SimdLevel simdLevelDetected = SimdLevel::Generic;
+ClassifySegmentsFn classifySegments = classifySegmentsGeneric;
+ClipHomogeneousFn clipHomogeneous = clipHomogeneousGeneric;
+
+void bindSimdLevel(SimdLevel l)
+{
+    simdLevel = l;
+    switch (l) {
+#ifdef HAVE_CPU_DISPATCH
+        case SimdLevel::AVX512:
+            classifySegments = classifySegmentsAVX512; clipHomogeneous = clipHomogeneousAVX512; break;
+        case SimdLevel::AVX2:
+            classifySegments = classifySegmentsAVX2; clipHomogeneous = clipHomogeneousAVX2; break;
+        case SimdLevel::SSE42:
+            classifySegments = classifySegmentsSSE42; clipHomogeneous = clipHomogeneousSSE42; break;
+#endif
+        default:
+            classifySegments = classifySegmentsGeneric; clipHomogeneous = clipHomogeneousGeneric; break;
+    }
+}
+
+// Detect once at startup; an override above what the CPU supports is clamped
+void initCpuDispatch()
+{
+#ifdef HAVE_CPU_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))     simdLevelDetected = SimdLevel::AVX512;
+    else if (__builtin_cpu_supports("avx2"))   simdLevelDetected = SimdLevel::AVX2;
+    else if (__builtin_cpu_supports("sse4.2")) simdLevelDetected = SimdLevel::SSE42;
+#endif
+    SimdLevel level = simdLevelDetected;
+    if (const char *env = std::getenv("CLIP_SIMD_LEVEL")) {
+        SimdLevel forced = level;
+        bool known = true;
+        if (!std::strcmp(env, "generic"))      forced = SimdLevel::Generic;
+        else if (!std::strcmp(env, "sse4.2"))  forced = SimdLevel::SSE42;
+        else if (!std::strcmp(env, "avx2"))    forced = SimdLevel::AVX2;
+        else if (!std::strcmp(env, "avx512"))  forced = SimdLevel::AVX512;
+        else known = false;
+        if (!known) std::cerr << "Unknown CLIP_SIMD_LEVEL '" << env << "'; ignoring.\n";
+        else if (forced > simdLevelDetected)
+            std::cerr << "CLIP_SIMD_LEVEL=" << env << " not supported by this CPU; using "
+                      << simdLevelName(simdLevelDetected) << ".\n";
+        else level = forced;
+    }
+    bindSimdLevel(level);
+    std::cout << "SIMD level: " << simdLevelName(simdLevel) << " (detected "
+              << simdLevelName(simdLevelDetected) << ")\n";
+}
+
+// Clip columns against the window after transform m, recording only which
+// segments are visible and their parameter intervals. Liang-Barsky parameters
+// are invariant under affine maps, so axis-aligned transforms clip the
+// untransformed data against the inverse-mapped window.
+void clipColumnsLazy(const SegmentColumns &c, const Affine2D &m,
+                     double xmin, double ymin, double xmax, double ymax,
+                     ClipResult &out)
+{
+    const size_t n = c.size();
+    out.whole.assign((n + 63) / 64, 0);
+    out.partial.clear();
+    out.wholeCount = 0;
+
+    bool axis = isAxisAligned(m);
+    Affine2D xf = m;
+    if (axis) {
+        double wx0 = (xmin - m.tx) / m.m00, wx1 = (xmax - m.tx) / m.m00;
+        double wy0 = (ymin - m.ty) / m.m11, wy1 = (ymax - m.ty) / m.m11;
+        xmin = std::min(wx0, wx1); xmax = std::max(wx0, wx1);
+        ymin = std::min(wy0, wy1); ymax = std::max(wy0, wy1);
+        xf = Affine2D();
+    }
+
+    // classify a block at a time with the dispatched kernel, then clip the stragglers
+    const size_t block = 256;
+    uint8_t cls[block];
+    size_t straddling = 0;
+    for (size_t b = 0; b < n; b += block) {
+        const size_t e = std::min(n, b + block);
+        {
+            INSTR_SCOPE("clip.classify");
+            classifySegments(c, b, e, xf, xmin, ymin, xmax, ymax, cls);
+        }
+        for (size_t i = b; i < e; ++i) {
+            if (cls[i - b] == CLIP_REJECT) continue;
+            if (cls[i - b] == CLIP_ACCEPT) {
+                out.whole[i >> 6] |= uint64_t(1) << (i & 63);
+                ++out.wholeCount;
+                continue;
+            }
+            ++straddling;
+            Point a = transformPoint(xf, c.x0[i], c.y0[i]), p = transformPoint(xf, c.x1[i], c.y1[i]);
+            double u1, u2;
+            if (liangBarskyParams(a.x, a.y, p.x, p.y, xmin, ymin, xmax, ymax, u1, u2))
+                out.partial.push_back({ static_cast<uint32_t>(i), float(u1), float(u2) });
+        }
+    }
+    INSTR_COUNT("clip.segments", n);
+    INSTR_COUNT("clip.accepted", out.wholeCount);
+    INSTR_COUNT("clip.rejected", n - out.wholeCount - straddling);
+    INSTR_COUNT("clip.straddling", straddling);
+    INSTR_COUNT("clip.straddling_visible", out.partial.size());
+}
+
+// Clip a batch of clip-space segments to the view frustum, a block at a time
+// through the dispatched kernel: accepted segments are copied, rejected ones
+// skipped and straddling ones cut to their visible interval.
+void clipHomogeneousBatch(const HomogeneousColumns &in, HomogeneousColumns &out, size_t &straddling)
+{
+    out.clear();
+    straddling = 0;
+    const size_t n = in.size();
+    const size_t block = 256;
+    uint8_t cls[block];
+    double u1[block], u2[block];
+    for (size_t b = 0; b < n; b += block) {
+        const size_t e = std::min(n, b + block);
+        clipHomogeneous(in, b, e, cls, u1, u2);
+        for (size_t i = b; i < e; ++i) {
+            if (cls[i - b] == CLIP_REJECT) continue;
+            if (cls[i - b] == CLIP_ACCEPT) {
+                out.push(in.x0[i], in.y0[i], in.z0[i], in.w0[i], in.x1[i], in.y1[i], in.z1[i], in.w1[i]);
+                continue;
+            }
+            ++straddling;
+            double a = u1[i - b], t = u2[i - b];
+            if (a > t) continue;
+            double dx = in.x1[i] - in.x0[i], dy = in.y1[i] - in.y0[i];
+            double dz = in.z1[i] - in.z0[i], dw = in.w1[i] - in.w0[i];
+            out.push(in.x0[i] + a * dx, in.y0[i] + a * dy, in.z0[i] + a * dz, in.w0[i] + a * dw,
+                     in.x0[i] + t * dx, in.y0[i] + t * dy, in.z0[i] + t * dz, in.w0[i] + t * dw);
+        }
+    }
+    INSTR_COUNT("frustum.segments", n);
+    INSTR_COUNT("frustum.straddling", straddling);
+}
+
+// Perspective divide and viewport mapping of frustum-clipped segments: NDC
+// [-1, 1]^2 maps onto the rectangle [xmin, xmax] x [ymin, ymax]
+void projectToViewport(const HomogeneousColumns &c, double xmin, double ymin, double xmax, double ymax,
+                       std::vector<Segment> &out)
+{
+    out.clear();
+    double sx = 0.5 * (xmax - xmin), sy = 0.5 * (ymax - ymin);
+    for (size_t i = 0; i < c.size(); ++i) {
+        if (c.w0[i] <= 0.0 || c.w1[i] <= 0.0) continue;   // only where the eye plane is crossed exactly
+        out.push_back({ { xmin + (c.x0[i] / c.w0[i] + 1.0) * sx, ymin + (c.y0[i] / c.w0[i] + 1.0) * sy },
+                        { xmin + (c.x1[i] / c.w1[i] + 1.0) * sx, ymin + (c.y1[i] / c.w1[i] + 1.0) * sy } });
+    }
+}
+
+// Clip-space wireframe of a grid of unit cubes seen through a perspective camera,
+// roughly what a CAD model looks like after the model-view-projection transform
+void cubeGridWireframe(int gridN, HomogeneousColumns &out)
+{
+    out.clear();
+    const double f = 1.0 / std::tan(0.5 * 60.0 * 3.14159265358979323846 / 180.0); // 60 deg fov
+    const double zn = 0.5, zf = 200.0;
+    auto project = [&](double x, double y, double z, double *clip) {
+        clip[0] = f * x;
+        clip[1] = f * y;
+        clip[2] = (zf + zn) / (zn - zf) * z + 2.0 * zf * zn / (zn - zf);
+        clip[3] = -z;
+    };
+    static const int edges[12][2] = { {0,1},{1,3},{3,2},{2,0},{4,5},{5,7},{7,6},{6,4},{0,4},{1,5},{2,6},{3,7} };
+    for (int gx = 0; gx < gridN; ++gx) {
+        for (int gy = 0; gy < gridN; ++gy) {
+            for (int gz = 0; gz < gridN; ++gz) {
+                double ox = (gx - gridN / 2) * 2.0, oy = (gy - gridN / 2) * 2.0, oz = -2.0 - gz * 2.0;
+                double corners[8][4];
+                for (int c = 0; c < 8; ++c)
+                    project(ox + (c & 1), oy + ((c >> 1) & 1), oz - ((c >> 2) & 1), corners[c]);
+                for (const auto &e : edges) {
+                    const double *a = corners[e[0]], *b = corners[e[1]];
+                    out.push(a[0], a[1], a[2], a[3], b[0], b[1], b[2], b[3]);
+                }
+            }
+        }
+    }
+}
+
+// Clip every segment against all tiles of a uniform grid over [xmin,xmax]x[ymin,ymax]
+// in one pass. Each segment is clipped to the grid bounds once, then walked
+// cell by cell (DDA / grid traversal) and every piece goes into its tile's bin,
+// so the cost is O(segments + tiles touched) rather than O(segments x tiles).
+void clipColumnsToTiles(const SegmentColumns &c, double xmin, double ymin, double xmax, double ymax,
+                        int nx, int ny, TileBins &out)
+{
+    out.nx = nx; out.ny = ny;
+    out.bins.resize(size_t(nx) * ny);
+    for (auto &b : out.bins) b.clear();
+
+    const double tw = (xmax - xmin) / nx, th = (ymax - ymin) / ny;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < c.size(); ++i) {
+        double x0 = c.x0[i], y0 = c.y0[i], dx = c.x1[i] - x0, dy = c.y1[i] - y0;
+        double u1, u2;
+        if (!liangBarskyParams(x0, y0, c.x1[i], c.y1[i], xmin, ymin, xmax, ymax, u1, u2)) continue;
+
+        // starting cell from the entry point
+        int cx = clamp(int(std::floor((x0 + u1 * dx - xmin) / tw)), 0, nx - 1);
+        int cy = clamp(int(std::floor((y0 + u1 * dy - ymin) / th)), 0, ny - 1);
+        int stepX = dx > 0 ? 1 : -1, stepY = dy > 0 ? 1 : -1;
+        // parameter at which the walk crosses the next vertical / horizontal grid line
+        double tMaxX = dx > 0 ? (xmin + (cx + 1) * tw - x0) / dx : dx < 0 ? (xmin + cx * tw - x0) / dx : inf;
+        double tMaxY = dy > 0 ? (ymin + (cy + 1) * th - y0) / dy : dy < 0 ? (ymin + cy * th - y0) / dy : inf;
+        double tDeltaX = dx != 0 ? tw / std::fabs(dx) : inf;
+        double tDeltaY = dy != 0 ? th / std::fabs(dy) : inf;
+
+        double u = u1;
+        for (;;) {
+            double uNext = std::min({ tMaxX, tMaxY, u2 });
+            if (uNext > u || u1 == u2)
+                out.bins[size_t(cy) * nx + cx].push_back({ { x0 + u * dx, y0 + u * dy },
+                                                           { x0 + uNext * dx, y0 + uNext * dy } });
+            if (uNext >= u2) break;
+            if (tMaxX < tMaxY) { cx += stepX; tMaxX += tDeltaX; }
+            else               { cy += stepY; tMaxY += tDeltaY; }
+            if (cx < 0 || cx >= nx || cy < 0 || cy >= ny) break;
+            u = uNext;
+        }
+    }
+}
+
+// Index of the lowest set bit (bits != 0)
+inline int lowestSetBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int n = 0;
+    for (; !(bits & 1); bits >>= 1) ++n;
+    return n;
+#endif
+}
+
+// Materialize the clipped segments in source order and pass each to fn(Segment)
+template <typename Fn>
+void forEachClipped(const ClipResult &r, const SegmentColumns &c, const Affine2D &m, Fn &&fn)
+{
+    auto lerp = [&](size_t i, double u) {
+        return transformPoint(m, c.x0[i] + u * (c.x1[i] - c.x0[i]), c.y0[i] + u * (c.y1[i] - c.y0[i]));
+    };
+    size_t p = 0;
+    auto emitPartialBefore = [&](size_t limit) {
+        for (; p < r.partial.size() && r.partial[p].index < limit; ++p)
+            fn(Segment{ lerp(r.partial[p].index, r.partial[p].u1), lerp(r.partial[p].index, r.partial[p].u2) });
+    };
+    for (size_t w = 0; w < r.whole.size(); ++w) {
+        for (uint64_t bits = r.whole[w]; bits; bits &= bits - 1) {
+            size_t i = w * 64 + lowestSetBit(bits);
+            emitPartialBefore(i);
+            fn(Segment{ transformPoint(m, c.x0[i], c.y0[i]), transformPoint(m, c.x1[i], c.y1[i]) });
+        }
+    }
+    emitPartialBefore(c.size());
+}
+
+// Post-clip decimation: snap clipped endpoints to the pixel grid, collapse
+// segments that fall within a single pixel to a dot (one per pixel, drawn by the
+// endpoint markers) and merge consecutive collinear segments that continue each
+// other. Keeps draw volume tied to screen resolution instead of input size when
+// many sub-pixel segments survive clipping.
+void decimateClipped()
+{
+    decimated.clear();
+    if (clipped.count() == 0 || winWidth <= 0 || winHeight <= 0) return;
+
+    double sx = winWidth / (viewRight - viewLeft);
+    double sy = winHeight / (viewTop - viewBottom);
+    auto toPixel = [&](const Point &p, long &px, long &py) {
+        px = std::lround((p.x - viewLeft) * sx);
+        py = std::lround((p.y - viewBottom) * sy);
+    };
+    auto toWorld = [&](long px, long py) {
+        return Point{ viewLeft + px / sx, viewBottom + py / sy };
+    };
+
+    // current run being extended, in pixel coordinates
+    bool haveRun = false;
+    long rx0 = 0, ry0 = 0, rx1 = 0, ry1 = 0;
+    std::unordered_set<uint64_t> dotPixels;   // pixels that already got a dot
+
+    forEachClipped(clipped, simplifiedCols, viewTransform, [&](const Segment &c) {
+        long ax, ay, bx, by;
+        toPixel(c.a, ax, ay);
+        toPixel(c.b, bx, by);
+        bool dot = ax == bx && ay == by;   // sub-pixel on screen
+        // a dot on an end of the current run is already covered by it
+        if (dot && haveRun && ((ax == rx1 && ay == ry1) || (ax == rx0 && ay == ry0))) return;
+        if (dot && !dotPixels.insert((uint64_t(uint32_t(ax)) << 32) | uint32_t(ay)).second) return;
+
+        if (haveRun && ax == rx1 && ay == ry1) {
+            long dx0 = rx1 - rx0, dy0 = ry1 - ry0;
+            long dx1 = bx - ax,   dy1 = by - ay;
+            // a dot run grows into any direction; otherwise same direction and collinear
+            if ((dx0 == 0 && dy0 == 0) || (dx0 * dy1 - dy0 * dx1 == 0 && dx0 * dx1 + dy0 * dy1 > 0)) {
+                rx1 = bx; ry1 = by;
+                return;
+            }
+        }
+        if (haveRun) decimated.push_back({ toWorld(rx0, ry0), toWorld(rx1, ry1) });
+        rx0 = ax; ry0 = ay; rx1 = bx; ry1 = by;
+        haveRun = true;
+    });
+    if (haveRun) decimated.push_back({ toWorld(rx0, ry0), toWorld(rx1, ry1) });
+}
+
+// Draw utility: draw a line segment with given width and color
+void drawLine(const Point &p1, const Point &p2, float width=2.0f)
+{
+    glLineWidth(width);
+    glBegin(GL_LINES);
+      glVertex2d(p1.x, p1.y);
+      glVertex2d(p2.x, p2.y);
+    glEnd();
+}
+
+#ifdef HAVE_INSTANCED_GL
+GLuint segmentProgram = 0, pointProgram = 0;
+GLuint cornerVbo = 0, instanceVbo = 0;
+GLsizei instanceCount = 0;
+
+// Each instance is one segment (endpoints in pixels); the 4 shared corners pick
+// the end (x) and side (y) of the quad
+const char* segmentVertexSrc = R"(#version 130
+in vec2 corner;
+in vec4 segment;
+uniform vec2 viewport;
+uniform float halfWidth;
+void main() {
+    vec2 d = segment.zw - segment.xy;
+    float len = length(d);
+    vec2 dir = len > 0.0 ? d / len : vec2(1.0, 0.0);
+    vec2 n = vec2(-dir.y, dir.x);
+    vec2 p = mix(segment.xy, segment.zw, corner.x) + n * halfWidth * corner.y;
+    gl_Position = vec4(p / viewport * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Endpoint markers: one point sprite per instance, rounded in the fragment shader
+const char* pointVertexSrc = R"(#version 130
+in vec2 position;
+uniform vec2 viewport;
+uniform float pointSize;
+void main() {
+    gl_Position = vec4(position / viewport * 2.0 - 1.0, 0.0, 1.0);
+    gl_PointSize = pointSize;
+}
+)";
+
+const char* solidFragmentSrc = R"(#version 130
+uniform vec4 color;
+uniform bool roundPoint;
+out vec4 fragColor;
+void main() {
+    if (roundPoint && length(gl_PointCoord - vec2(0.5)) > 0.5) discard;
+    fragColor = color;
+}
+)";
+
+// Needs a current GL context; returns false if GL 3.3 features are missing
+bool initInstancedRendering()
+{
+    if (!glVersionAtLeast(3, 3)) return false;
+
+    segmentProgram = linkProgram(segmentVertexSrc, solidFragmentSrc, { "corner", "segment" });
+    pointProgram = linkProgram(pointVertexSrc, solidFragmentSrc, { "position" });
+    if (!segmentProgram || !pointProgram) return false;
+
+    const float corners[8] = { 0, -1,  0, 1,  1, -1,  1, 1 }; // triangle strip
+    glGenBuffers(1, &cornerVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glGenBuffers(1, &instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+// Copy the decimated segments into the instance buffer as pixel coordinates
+void uploadInstances()
+{
+    double sx = winWidth / (viewRight - viewLeft);
+    double sy = winHeight / (viewTop - viewBottom);
+    std::vector<float> data;
+    data.reserve(decimated.size() * 4);
+    for (const auto &c : decimated) {
+        data.push_back(float((c.a.x - viewLeft) * sx));
+        data.push_back(float((c.a.y - viewBottom) * sy));
+        data.push_back(float((c.b.x - viewLeft) * sx));
+        data.push_back(float((c.b.y - viewBottom) * sy));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instanceCount = static_cast<GLsizei>(decimated.size());
+    instancesDirty = false;
+}
+
+// One instanced draw for all segment quads, one for all endpoint sprites
+void drawInstanced(float width, float pointSize, const float color[4])
+{
+    if (instancesDirty) uploadInstances();
+    if (instanceCount == 0) return;
+
+    glUseProgram(segmentProgram);
+    glUniform2f(glGetUniformLocation(segmentProgram, "viewport"), float(winWidth), float(winHeight));
+    glUniform1f(glGetUniformLocation(segmentProgram, "halfWidth"), width * 0.5f);
+    glUniform4fv(glGetUniformLocation(segmentProgram, "color"), 1, color);
+    glUniform1i(glGetUniformLocation(segmentProgram, "roundPoint"), 0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glVertexAttribDivisor(1, 1);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceCount);
+    glVertexAttribDivisor(1, 0);
+    glDisableVertexAttribArray(1);
+
+    // the same buffer read as a stream of vec2 gives both endpoints of every segment
+    glUseProgram(pointProgram);
+    glUniform2f(glGetUniformLocation(pointProgram, "viewport"), float(winWidth), float(winHeight));
+    glUniform1f(glGetUniformLocation(pointProgram, "pointSize"), pointSize);
+    glUniform4fv(glGetUniformLocation(pointProgram, "color"), 1, color);
+    glUniform1i(glGetUniformLocation(pointProgram, "roundPoint"), 1);
+    // gl_PointSize and gl_PointCoord both need enabling in a compatibility context
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_POINT_SPRITE);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glVertexAttribDivisor(0, 1);
+    glDrawArraysInstanced(GL_POINTS, 0, 1, instanceCount * 2);
+    glVertexAttribDivisor(0, 0);
+    glDisableVertexAttribArray(0);
+    glDisable(GL_POINT_SPRITE);
+    glDisable(GL_PROGRAM_POINT_SIZE);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+#endif
+
+// Display callback
+void display()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // Draw clipping rectangle (blue)
+    glColor3f(0.0f, 0.0f, 1.0f);
+    glLineWidth(2.5f);
+    glBegin(GL_LINE_LOOP);
+      glVertex2d(xmin_w, ymin_w);
+      glVertex2d(xmax_w, ymin_w);
+      glVertex2d(xmax_w, ymax_w);
+      glVertex2d(xmin_w, ymax_w);
+    glEnd();
+
+    // Draw original lines in red (thin, partially transparent look using stipple),
+    // mapped from world space by the view transform
+    const Affine2D &m = viewTransform;
+    const double mat[16] = { m.m00, m.m10, 0, 0,  m.m01, m.m11, 0, 0,  0, 0, 1, 0,  m.tx, m.ty, 0, 1 };
+    glPushMatrix();
+    glMultMatrixd(mat);
+    glColor3f(0.8f, 0.1f, 0.1f); // red
+    glLineWidth(1.5f);
+    for (const auto &seg : segments) {
+        drawLine(seg.a, seg.b, 1.5f);
+    }
+    glPopMatrix();
+
+    // 3D wireframe, frustum-clipped and projected into the clipping window (purple)
+    if (showWireframe) {
+        glColor3f(0.45f, 0.2f, 0.7f);
+        glLineWidth(1.0f);
+        glBegin(GL_LINES);
+        for (const auto &w : wireframeProjected) {
+            glVertex2d(w.a.x, w.a.y);
+            glVertex2d(w.b.x, w.b.y);
+        }
+        glEnd();
+    }
+
+#ifdef HAVE_INSTANCED_GL
+    if (useInstancedRendering && instancedReady) {
+        const float green[4] = { 0.05f, 0.6f, 0.05f, 1.0f };
+        drawInstanced(3.5f, 6.0f, green);
+        glutSwapBuffers();
+        return;
+    }
+#endif
+
+    // Draw clipped segments in green (overlay)
+    glColor3f(0.05f, 0.6f, 0.05f); // green
+    glLineWidth(3.5f);
+    for (const auto &c : decimated) {
+        drawLine(c.a, c.b, 3.5f);
+    }
+
+    // Optional: draw endpoints of clipped segments as small points
+    glPointSize(6.0f);
+    glBegin(GL_POINTS);
+    for (const auto &c : decimated) {
+        glVertex2d(c.a.x, c.a.y);
+        glVertex2d(c.b.x, c.b.y);
+    }
+    glEnd();
+
+    glutSwapBuffers();
+}
+
+// Reshape callback - set orthographic projection to cover the clipping window nicely
+void reshape(int w, int h)
+{
+    winWidth = w; winHeight = h;
+    glViewport(0, 0, w, h);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+
+    // compute a small margin around the clipping rectangle so we can see everything
+    double width = xmax_w - xmin_w;
+    double height = ymax_w - ymin_w;
+    double marginX = std::max(10.0, width * 0.15);
+    double marginY = std::max(10.0, height * 0.15);
+
+    double left = xmin_w - marginX;
+    double right = xmax_w + marginX;
+    double bottom = ymin_w - marginY;
+    double top = ymax_w + marginY;
+
+    // keep aspect ratio by expanding whichever dimension is smaller
+    double aspectWindow = (right - left) / (top - bottom);
+    double aspectViewport = double(w) / double(h);
+    if (aspectViewport > aspectWindow) {
+        // viewport wider -> expand x-range
+        double extra = ((top - bottom) * aspectViewport - (right - left)) * 0.5;
+        left -= extra; right += extra;
+    } else {
+        double extra = ((right - left) / aspectViewport - (top - bottom)) * 0.5;
+        bottom -= extra; top += extra;
+    }
+
+    gluOrtho2D(left, right, bottom, top);
+
+    // pixel size changed -> redo simplification, clipping and decimation
+    viewLeft = left; viewRight = right; viewBottom = bottom; viewTop = top;
+    updateView();
+}
+
+// Zoom the clipping window around its centre (factor < 1 zooms in)
+void zoomWindow(double factor)
+{
+    double cx = (xmin_w + xmax_w) * 0.5, cy = (ymin_w + ymax_w) * 0.5;
+    double hw = (xmax_w - xmin_w) * 0.5 * factor, hh = (ymax_w - ymin_w) * 0.5 * factor;
+    xmin_w = cx - hw; xmax_w = cx + hw;
+    ymin_w = cy - hh; ymax_w = cy + hh;
+}
+
+// Rotate the data (view transform) about the clipping window centre
+void rotateView(double degrees)
+{
+    double a = degrees * 3.14159265358979323846 / 180.0;
+    double cx = (xmin_w + xmax_w) * 0.5, cy = (ymin_w + ymax_w) * 0.5;
+    Affine2D r;
+    r.m00 = std::cos(a); r.m01 = -std::sin(a);
+    r.m10 = std::sin(a); r.m11 =  std::cos(a);
+    r.tx = cx - (r.m00 * cx + r.m01 * cy);
+    r.ty = cy - (r.m10 * cx + r.m11 * cy);
+    viewTransform = compose(r, viewTransform);
+}
+
+// Keyboard: press ESC or q to quit, +/- to zoom, r/R to rotate, b to benchmark,
+// v to toggle view-update statistics, w to toggle the 3D wireframe
+void keyboard(unsigned char key, int x, int y)
+{
+    if (key == 27 || key == 'q' || key == 'Q') {
+        exit(0);
+    }
+    if (key == '+' || key == '=' || key == '-') {
+        zoomWindow(key == '-' ? 1.25 : 0.8);
+        reshape(winWidth, winHeight);
+        glutPostRedisplay();
+    }
+    if (key == 'r' || key == 'R') {
+        rotateView(key == 'r' ? 15.0 : -15.0);
+        reshape(winWidth, winHeight);
+        glutPostRedisplay();
+    }
+    if (key == 'b' || key == 'B') {
+        runBenchmarks();
+    }
+    if (key == 'v' || key == 'V') {
+        verboseView = !verboseView;
+        std::cout << "View statistics " << (verboseView ? "on" : "off") << "\n";
+        if (verboseView) updateView();
+    }
+    if (key == 'w' || key == 'W') {
+        showWireframe = !showWireframe;
+        if (showWireframe && wireframe.size() == 0) {
+            size_t straddling = 0;
+            cubeGridWireframe(12, wireframe);
+            clipHomogeneousBatch(wireframe, wireframeClipped, straddling);
+            std::cout << "Wireframe: " << wireframe.size() << " edges -> " << wireframeClipped.size()
+                      << " after the frustum clip (" << straddling << " straddling)\n";
+        }
+        updateView();
+        glutPostRedisplay();
+    }
+}
+
+// Arrow keys pan the clipping window by 10% of its size
+void special(int key, int, int)
+{
+    double stepX = (xmax_w - xmin_w) * 0.1, stepY = (ymax_w - ymin_w) * 0.1;
+    switch (key) {
+        case GLUT_KEY_LEFT:  xmin_w -= stepX; xmax_w -= stepX; break;
+        case GLUT_KEY_RIGHT: xmin_w += stepX; xmax_w += stepX; break;
+        case GLUT_KEY_DOWN:  ymin_w -= stepY; ymax_w -= stepY; break;
+        case GLUT_KEY_UP:    ymin_w += stepY; ymax_w += stepY; break;
+        default: return;
+    }
+    reshape(winWidth, winHeight);
+    glutPostRedisplay();
+}
+
+// Hilbert curve index of cell (x, y) on a 2^16 x 2^16 grid
+uint32_t hilbertIndex(uint32_t x, uint32_t y)
+{
+    uint32_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the curve stays continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// LSD radix sort of (key, index) pairs, 8 bits per pass.
+// Each pass splits the input into one chunk per thread: threads build local
+// histograms, a shared prefix sum gives every (digit, thread) its output slot,
+// then threads scatter their chunk independently (stable).
+void radixSortPairs(std::vector<std::pair<uint32_t,uint32_t>> &items)
+{
+    const size_t n = items.size();
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (n < 65536) nThreads = 1; // not worth spawning threads for small inputs
+    const size_t chunk = (n + nThreads - 1) / nThreads;
+
+    std::vector<std::pair<uint32_t,uint32_t>> tmp(n);
+    std::vector<size_t> offsets(256 * nThreads);
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        auto countChunk = [&](unsigned t) {
+            size_t *hist = &offsets[t * 256];
+            std::fill(hist, hist + 256, 0);
+            size_t end = std::min(n, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i) ++hist[(items[i].first >> shift) & 0xFF];
+        };
+        auto scatterChunk = [&](unsigned t) {
+            size_t *pos = &offsets[t * 256];
+            size_t end = std::min(n, (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i) tmp[pos[(items[i].first >> shift) & 0xFF]++] = items[i];
+        };
+        auto runAll = [&](auto &&fn) {
+            if (nThreads == 1) { fn(0u); return; }
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < nThreads; ++t) workers.emplace_back(fn, t);
+            for (auto &w : workers) w.join();
+        };
+
+        runAll(countChunk);
+
+        // exclusive prefix sum in (digit, thread) order keeps the sort stable
+        size_t sum = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            for (unsigned t = 0; t < nThreads; ++t) {
+                size_t c = offsets[t * 256 + digit];
+                offsets[t * 256 + digit] = sum;
+                sum += c;
+            }
+        }
+
+        runAll(scatterChunk);
+        items.swap(tmp);
+    }
+}
+
+// Sort with one std::sort per thread on contiguous chunks, then pairwise merges
+template <typename T, typename Cmp>
+void parallelSort(std::vector<T> &items, Cmp cmp)
+{
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (items.size() < 65536 || nThreads == 1) {
+        std::sort(items.begin(), items.end(), cmp);
+        return;
+    }
+    const size_t chunk = (items.size() + nThreads - 1) / nThreads;
+
+    std::vector<size_t> bounds;
+    for (size_t b = 0; b < items.size(); b += chunk) bounds.push_back(b);
+    bounds.push_back(items.size());
+
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k + 1 < bounds.size(); ++k)
+        workers.emplace_back([&, k] { std::sort(items.begin() + bounds[k], items.begin() + bounds[k + 1], cmp); });
+    for (auto &w : workers) w.join();
+
+    // merge neighbouring runs until one is left
+    while (bounds.size() > 2) {
+        std::vector<size_t> next;
+        workers.clear();
+        for (size_t k = 0; k + 1 < bounds.size(); k += 2) {
+            next.push_back(bounds[k]);
+            if (k + 2 < bounds.size())
+                workers.emplace_back([&, k] {
+                    std::inplace_merge(items.begin() + bounds[k], items.begin() + bounds[k + 1],
+                                       items.begin() + bounds[k + 2], cmp);
+                });
+        }
+        for (auto &w : workers) w.join();
+        next.push_back(items.size());
+        bounds.swap(next);
+    }
+}
+
+// Quantized endpoints of a segment with a canonical direction (lower endpoint first)
+struct EndpointKey {
+    int64_t ax, ay, bx, by;
+    bool operator==(const EndpointKey &o) const { return ax == o.ax && ay == o.ay && bx == o.bx && by == o.by; }
+};
+
+struct EndpointKeyHash {
+    size_t operator()(const EndpointKey &k) const {
+        uint64_t h = 1469598103934665603ull;
+        for (int64_t v : { k.ax, k.ay, k.bx, k.by }) h = (h ^ uint64_t(v)) * 1099511628211ull;
+        return size_t(h);
+    }
+};
+
+// Remove duplicate segments (either direction) and merge collinear segments that
+// overlap by more than dedupeQuantum (pieces that only touch are left alone).
+// Every survivor keeps its position and endpoint order, so polyline chains in the
+// input survive.
+void dedupeSegments(std::vector<Segment> &segs)
+{
+    const double q = dedupeQuantum;
+    auto quant = [q](double v) { return static_cast<int64_t>(std::llround(v / q)); };
+
+    // 1) exact duplicates by hashing canonical quantized endpoints
+    std::unordered_set<EndpointKey, EndpointKeyHash> seen;
+    seen.reserve(segs.size() * 2);
+    std::vector<Segment> unique;
+    unique.reserve(segs.size());
+    for (const auto &s : segs) {
+        EndpointKey k{ quant(s.a.x), quant(s.a.y), quant(s.b.x), quant(s.b.y) };
+        if (std::tie(k.bx, k.by) < std::tie(k.ax, k.ay)) { std::swap(k.ax, k.bx); std::swap(k.ay, k.by); }
+        if (seen.insert(k).second) unique.push_back(s);
+    }
+
+    // 2) collinear overlap merging: key each segment by its supporting line
+    //    (canonical unit direction + signed offset), sort by key and start
+    //    parameter, then sweep each line's intervals. The direction is quantized
+    //    to q / extent so that lines sharing a key stay within about q of each
+    //    other anywhere inside the data, like the offset.
+    struct LineItem {
+        int64_t dirX, dirY, offset;
+        double t0, t1;
+        uint32_t index;
+    };
+    double extent = q;
+    for (const auto &s : unique)
+        extent = std::max({ extent, std::fabs(s.a.x), std::fabs(s.a.y), std::fabs(s.b.x), std::fabs(s.b.y) });
+    const double dirQ = std::max(q / extent, 1e-15);   // bounded so the keys fit in 64 bits
+
+    std::vector<LineItem> items;
+    items.reserve(unique.size());
+    for (size_t i = 0; i < unique.size(); ++i) {
+        const Segment &s = unique[i];
+        double dx = s.b.x - s.a.x, dy = s.b.y - s.a.y;
+        double len = std::sqrt(dx * dx + dy * dy);
+        if (len <= q) continue;
+        dx /= len; dy /= len;
+        if (dx < 0 || (dx == 0 && dy < 0)) { dx = -dx; dy = -dy; }
+        double t0 = s.a.x * dx + s.a.y * dy, t1 = s.b.x * dx + s.b.y * dy;
+        if (t0 > t1) std::swap(t0, t1);
+        items.push_back({ std::llround(dx / dirQ), std::llround(dy / dirQ),
+                          quant(dx * s.a.y - dy * s.a.x), t0, t1, static_cast<uint32_t>(i) });
+    }
+    parallelSort(items, [](const LineItem &a, const LineItem &b) {
+        return std::tie(a.dirX, a.dirY, a.offset, a.t0) < std::tie(b.dirX, b.dirY, b.offset, b.t0);
+    });
+
+    std::vector<char> consumed(unique.size(), 0);
+    for (size_t r = 0; r < items.size();) {
+        // extend the run while the next interval on the same line overlaps it
+        size_t e = r + 1;
+        double runEnd = items[r].t1;
+        uint32_t first = items[r].index;
+        while (e < items.size() && items[e].dirX == items[r].dirX && items[e].dirY == items[r].dirY
+               && items[e].offset == items[r].offset && items[e].t0 < runEnd - q) {
+            runEnd = std::max(runEnd, items[e].t1);
+            first = std::min(first, items[e].index);
+            ++e;
+        }
+        if (e - r > 1) {
+            // rebuild the merged segment on the line of the earliest member (the
+            // one kept), in that member's direction
+            Segment &s = unique[first];
+            double dx = s.b.x - s.a.x, dy = s.b.y - s.a.y;
+            double len = std::sqrt(dx * dx + dy * dy);
+            dx /= len; dy /= len;
+            bool reversed = dx < 0 || (dx == 0 && dy < 0);
+            if (reversed) { dx = -dx; dy = -dy; }
+            double c = dx * s.a.y - dy * s.a.x;
+            for (size_t k = r; k < e; ++k) consumed[items[k].index] = 1;
+            consumed[first] = 0;
+            Point lo{ items[r].t0 * dx - c * dy, items[r].t0 * dy + c * dx };
+            Point hi{ runEnd * dx - c * dy,      runEnd * dy + c * dx };
+            s = reversed ? Segment{ hi, lo } : Segment{ lo, hi };
+        }
+        r = e;
+    }
+
+    segs.clear();
+    for (size_t i = 0; i < unique.size(); ++i)
+        if (!consumed[i]) segs.push_back(unique[i]);
+}
+
+// Average distance between midpoints of consecutive segments (lower = better locality)
+double averageMidpointStride(const std::vector<Segment> &segs)
+{
+    if (segs.size() < 2) return 0.0;
+    double total = 0.0;
+    for (size_t i = 1; i < segs.size(); ++i) {
+        double dx = (segs[i].a.x + segs[i].b.x - segs[i-1].a.x - segs[i-1].b.x) * 0.5;
+        double dy = (segs[i].a.y + segs[i].b.y - segs[i-1].a.y - segs[i-1].b.y) * 0.5;
+        total += std::sqrt(dx * dx + dy * dy);
+    }
+    return total / double(segs.size() - 1);
+}
+
+// Reorder segments by the Hilbert index of their midpoint. The unit of the sort
+// is a polyline run (consecutive segments sharing an endpoint), keyed by the
+// centre of its bounding box, so the chains decimateClipped merges stay intact.
+void sortSegmentsSpatially(std::vector<Segment> &segs)
+{
+    if (segs.size() < 2) return;
+
+    // run r covers [runStart[r], runStart[r + 1]); centres[r] is its bounding-box centre
+    std::vector<size_t> runStart;
+    std::vector<Point> centres;
+    double bx0 = 0, by0 = 0, bx1 = 0, by1 = 0;
+    for (size_t i = 0; i <= segs.size(); ++i) {
+        bool split = i == segs.size() || i == 0 || segs[i].a.x != segs[i-1].b.x || segs[i].a.y != segs[i-1].b.y;
+        if (split && i > 0) centres.push_back({ (bx0 + bx1) * 0.5, (by0 + by1) * 0.5 });
+        if (i == segs.size()) break;
+        if (split) {
+            runStart.push_back(i);
+            bx0 = bx1 = segs[i].a.x;
+            by0 = by1 = segs[i].a.y;
+        }
+        bx0 = std::min({ bx0, segs[i].a.x, segs[i].b.x }); bx1 = std::max({ bx1, segs[i].a.x, segs[i].b.x });
+        by0 = std::min({ by0, segs[i].a.y, segs[i].b.y }); by1 = std::max({ by1, segs[i].a.y, segs[i].b.y });
+    }
+    runStart.push_back(segs.size());
+    if (centres.size() < 2) return;
+
+    // bounding box of all run centres, used to quantize onto the 16-bit Hilbert grid
+    double minX = centres[0].x, maxX = minX, minY = centres[0].y, maxY = minY;
+    for (const auto &c : centres) {
+        minX = std::min(minX, c.x); maxX = std::max(maxX, c.x);
+        minY = std::min(minY, c.y); maxY = std::max(maxY, c.y);
+    }
+    double scaleX = (maxX > minX) ? 65535.0 / (maxX - minX) : 0.0;
+    double scaleY = (maxY > minY) ? 65535.0 / (maxY - minY) : 0.0;
+
+    std::vector<std::pair<uint32_t,uint32_t>> keys(centres.size());
+    for (size_t r = 0; r < centres.size(); ++r) {
+        uint32_t qx = static_cast<uint32_t>((centres[r].x - minX) * scaleX);
+        uint32_t qy = static_cast<uint32_t>((centres[r].y - minY) * scaleY);
+        keys[r] = { hilbertIndex(qx, qy), static_cast<uint32_t>(r) };
+    }
+
+    radixSortPairs(keys);
+
+    std::vector<Segment> sorted;
+    sorted.reserve(segs.size());
+    for (const auto &k : keys)
+        sorted.insert(sorted.end(), segs.begin() + runStart[k.second], segs.begin() + runStart[k.second + 1]);
+    segs.swap(sorted);
+}
+
+// Chain consecutive input segments that share an endpoint into polylines
+void buildPolylines()
+{
+    polylines.clear();
+    for (const auto &s : segments) {
+        if (!polylines.empty()) {
+            const Point &last = polylines.back().back();
+            if (last.x == s.a.x && last.y == s.a.y) {
+                polylines.back().push_back(s.b);
+                continue;
+            }
+        }
+        polylines.push_back({ s.a, s.b });
+    }
+}
+
+// Visvalingam-Whyatt simplification of one polyline: repeatedly remove the interior
+// vertex whose triangle with its two neighbours has the smallest area, until all
+// remaining triangles are at least minArea. Uses a min-heap with lazy invalidation.
+void visvalingam(const std::vector<Point> &in, double minArea, std::vector<Point> &out)
+{
+    const int n = static_cast<int>(in.size());
+    if (n < 3 || minArea <= 0.0) { out = in; return; }
+
+    std::vector<int> prev(n), next(n);
+    std::vector<double> area(n, std::numeric_limits<double>::infinity());
+    std::vector<char> removed(n, 0);
+    for (int i = 0; i < n; ++i) { prev[i] = i - 1; next[i] = i + 1; }
+
+    auto triangleArea = [&](int i) {
+        const Point &a = in[prev[i]], &b = in[i], &c = in[next[i]];
+        return 0.5 * std::fabs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+    };
+
+    using Entry = std::pair<double,int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    for (int i = 1; i < n - 1; ++i) {
+        area[i] = triangleArea(i);
+        heap.push({ area[i], i });
+    }
+
+    while (!heap.empty()) {
+        Entry top = heap.top();
+        int i = top.second;
+        if (removed[i] || top.first != area[i]) { heap.pop(); continue; } // stale entry
+        if (top.first >= minArea) break;
+        heap.pop();
+
+        removed[i] = 1;
+        int p = prev[i], q = next[i];
+        next[p] = q;
+        prev[q] = p;
+        // neighbours never get a smaller area than the vertex just removed
+        if (p > 0)     { area[p] = std::max(triangleArea(p), top.first); heap.push({ area[p], p }); }
+        if (q < n - 1) { area[q] = std::max(triangleArea(q), top.first); heap.push({ area[q], q }); }
+    }
+
+    out.clear();
+    for (int i = 0; i < n; i = next[i]) out.push_back(in[i]);
+}
+
+// Simplify all polylines with a tolerance of simplifyTolerancePx screen pixels
+// (converted to world units with the current view scale), in parallel across
+// polylines, and flatten the result into segments for the clipper.
+void simplifyPolylines(double tol, std::vector<Segment> &out)
+{
+    double minArea = 0.5 * tol * tol;
+
+    std::vector<std::vector<Point>> results(polylines.size());
+    std::atomic<size_t> nextIndex{0};
+    auto worker = [&]() {
+        for (size_t i = nextIndex++; i < polylines.size(); i = nextIndex++)
+            visvalingam(polylines[i], minArea, results[i]);
+    };
+
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (polylines.size() < 64) nThreads = 1;
+    if (nThreads == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < nThreads; ++t) workers.emplace_back(worker);
+        for (auto &w : workers) w.join();
+    }
+
+    out.clear();
+    for (const auto &pl : results)
+        for (size_t i = 1; i < pl.size(); ++i) out.push_back({ pl[i-1], pl[i] });
+}
+
+// World size of one screen pixel for the current view
+double currentPixelSize()
+{
+    return std::max((viewRight - viewLeft) / std::max(1, winWidth),
+                    (viewTop - viewBottom) / std::max(1, winHeight));
+}
+
+// Build the LOD pyramid from the input polylines and write it to path.
+// Segments are assigned to the tile containing their midpoint; tile bounds are
+// grown to cover the whole segment so visibility tests stay conservative.
+bool writeLodPyramid(const char* path)
+{
+    if (segments.empty()) return false;
+
+    LodHeader hdr{ LOD_MAGIC, LOD_LEVELS, LOD_GRID, 0,
+                   segments[0].a.x, segments[0].a.y, segments[0].a.x, segments[0].a.y, 0.0 };
+    for (const auto &s : segments) {
+        hdr.minX = std::min({ hdr.minX, s.a.x, s.b.x }); hdr.maxX = std::max({ hdr.maxX, s.a.x, s.b.x });
+        hdr.minY = std::min({ hdr.minY, s.a.y, s.b.y }); hdr.maxY = std::max({ hdr.maxY, s.a.y, s.b.y });
+    }
+    double extent = std::max({ hdr.maxX - hdr.minX, hdr.maxY - hdr.minY, 1e-9 });
+    hdr.baseTolerance = extent / 65536.0;
+
+    std::vector<LodTile> tiles(size_t(LOD_LEVELS) * LOD_GRID * LOD_GRID);
+    std::vector<Segment> all;
+    std::vector<Segment> level;
+    std::vector<std::vector<Segment>> buckets(LOD_GRID * LOD_GRID);
+
+    for (int k = 0; k < LOD_LEVELS; ++k) {
+        simplifyPolylines(lodLevelTolerance(hdr, k), level);
+        for (auto &b : buckets) b.clear();
+        for (const auto &s : level) {
+            double mx = (s.a.x + s.b.x) * 0.5, my = (s.a.y + s.b.y) * 0.5;
+            int tx = std::min(LOD_GRID - 1, int((mx - hdr.minX) / extent * LOD_GRID));
+            int ty = std::min(LOD_GRID - 1, int((my - hdr.minY) / extent * LOD_GRID));
+            buckets[ty * LOD_GRID + tx].push_back(s);
+        }
+        for (int t = 0; t < LOD_GRID * LOD_GRID; ++t) {
+            LodTile &tile = tiles[size_t(k) * LOD_GRID * LOD_GRID + t];
+            tile.first = all.size();
+            tile.count = buckets[t].size();
+            tile.minX = tile.minY = std::numeric_limits<double>::infinity();
+            tile.maxX = tile.maxY = -std::numeric_limits<double>::infinity();
+            for (const auto &s : buckets[t]) {
+                tile.minX = std::min({ tile.minX, s.a.x, s.b.x }); tile.maxX = std::max({ tile.maxX, s.a.x, s.b.x });
+                tile.minY = std::min({ tile.minY, s.a.y, s.b.y }); tile.maxY = std::max({ tile.maxY, s.a.y, s.b.y });
+                all.push_back(s);
+            }
+        }
+    }
+
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1
+           && std::fwrite(tiles.data(), sizeof(LodTile), tiles.size(), f) == tiles.size()
+           && std::fwrite(all.data(), sizeof(Segment), all.size(), f) == all.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// Release the mapped (or read) pyramid
+void closeLodPyramid()
+{
+#ifdef HAVE_MMAP
+    if (lodData) munmap(const_cast<unsigned char*>(lodData), lodSize);
+#else
+    lodFallback.clear();
+#endif
+    lodData = nullptr;
+    lodSize = 0;
+    lodSegmentCount = 0;
+}
+
+// Segment range of a tile lies inside the segment area of the file
+inline bool lodTileInRange(const LodTile &tile)
+{
+    return tile.first <= lodSegmentCount && tile.count <= lodSegmentCount - tile.first;
+}
+
+// Check the header, that the tile table fits in the file and that every tile
+// addresses segments inside it; sets lodSegmentCount
+bool validateLodPyramid()
+{
+    if (lodSize < sizeof(LodHeader)) return false;
+    const LodHeader* hdr = reinterpret_cast<const LodHeader*>(lodData);
+    if (hdr->magic != LOD_MAGIC || hdr->levels < 1 || hdr->levels > 32 || hdr->grid < 1 || hdr->grid > 4096)
+        return false;
+    if (!std::isfinite(hdr->baseTolerance) || hdr->baseTolerance <= 0.0) return false;
+    uint64_t tileCount = uint64_t(hdr->levels) * hdr->grid * hdr->grid;
+    uint64_t segOffset = sizeof(LodHeader) + tileCount * sizeof(LodTile);
+    if (segOffset > lodSize) return false;
+    lodSegmentCount = (lodSize - segOffset) / sizeof(Segment);
+    const LodTile* tiles = reinterpret_cast<const LodTile*>(lodData + sizeof(LodHeader));
+    for (uint64_t t = 0; t < tileCount; ++t)
+        if (!lodTileInRange(tiles[t])) return false;
+    return true;
+}
+
+// Map the pyramid file into memory (or read it when mmap is not available).
+// A file that fails validation is released and rejected.
+bool openLodPyramid(const char* path)
+{
+    closeLodPyramid();
+#ifdef HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(LodHeader)) { close(fd); return false; }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    lodData = static_cast<const unsigned char*>(p);
+    lodSize = st.st_size;
+#else
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    lodFallback.resize(size > 0 ? size : 0);
+    size_t got = std::fread(lodFallback.data(), 1, lodFallback.size(), f);
+    std::fclose(f);
+    if (got != lodFallback.size() || got < sizeof(LodHeader)) return false;
+    lodData = lodFallback.data();
+    lodSize = lodFallback.size();
+#endif
+    if (!validateLodPyramid()) {
+        std::cerr << "LOD file " << path << " is truncated or corrupt; ignoring it.\n";
+        closeLodPyramid();
+        return false;
+    }
+    return true;
+}
+
+// Collect the segments of all tiles visible in the current view from the level
+// whose tolerance matches the pixel size. Returns the level used, or -1 when a
+// tile addresses segments outside the file.
+int loadVisibleTiles(std::vector<Segment> &out, size_t &tilesLoaded)
+{
+    const LodHeader* hdr = reinterpret_cast<const LodHeader*>(lodData);
+    const LodTile* tiles = reinterpret_cast<const LodTile*>(lodData + sizeof(LodHeader));
+    const Segment* segs = reinterpret_cast<const Segment*>(tiles + size_t(hdr->levels) * hdr->grid * hdr->grid);
+
+    double tol = simplifyTolerancePx * currentPixelSize();
+    int level = 0;
+    while (level + 1 < int(hdr->levels) && lodLevelTolerance(*hdr, level + 1) <= tol) ++level;
+
+    // bounds of the view in world space (the view transform may rotate the data)
+    Affine2D inv = inverse(viewTransform);
+    double wxMin = std::numeric_limits<double>::infinity(), wxMax = -wxMin, wyMin = wxMin, wyMax = -wxMin;
+    for (double cx : { viewLeft, viewRight }) {
+        for (double cy : { viewBottom, viewTop }) {
+            Point w = transformPoint(inv, cx, cy);
+            wxMin = std::min(wxMin, w.x); wxMax = std::max(wxMax, w.x);
+            wyMin = std::min(wyMin, w.y); wyMax = std::max(wyMax, w.y);
+        }
+    }
+
+    out.clear();
+    tilesLoaded = 0;
+    const LodTile* lv = tiles + size_t(level) * hdr->grid * hdr->grid;
+    for (uint32_t t = 0; t < hdr->grid * hdr->grid; ++t) {
+        const LodTile &tile = lv[t];
+        if (tile.count == 0) continue;
+        if (tile.maxX < wxMin || tile.minX > wxMax || tile.maxY < wyMin || tile.minY > wyMax) continue;
+        if (!lodTileInRange(tile)) {
+            out.clear();
+            return -1;
+        }
+        out.insert(out.end(), segs + tile.first, segs + tile.first + tile.count);
+        ++tilesLoaded;
+    }
+    return level;
+}
+
+// Prepare clipping for all (simplified) input segments. The view transform is
+// applied inside the clipping pass; degenerate results are kept. Results stay
+// lazy (see ClipResult) until decimation materializes them.
+void computeClipped()
+{
+    INSTR_SCOPE("clip.compute");
+    clipColumnsLazy(simplifiedCols, viewTransform, xmin_w, ymin_w, xmax_w, ymax_w, clipped);
+}
+
+// View-dependent pipeline: simplify -> spatial sort -> clip -> decimate
+void updateView()
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    int level = -1;
+    size_t tilesLoaded = 0;
+    if (useLodPyramid && lodData && (level = loadVisibleTiles(simplified, tilesLoaded)) < 0) {
+        std::cerr << "LOD file " << lodFilePath << " is corrupt; simplifying per view instead.\n";
+        closeLodPyramid();
+    }
+    if (level >= 0) {
+        if (verboseView) std::cout << "LOD level " << level << ", " << tilesLoaded << " tiles loaded\n";
+    } else {
+        simplifyPolylines(simplifyTolerancePx * currentPixelSize(), simplified);
+    }
+
+    // Optional spatial ordering pre-pass; report how much closer consecutive segments get
+    if (useSpatialSort && simplified.size() > 1) {
+        double before = verboseView ? averageMidpointStride(simplified) : 0.0;
+        sortSegmentsSpatially(simplified);
+        if (verboseView)
+            std::cout << "Hilbert sort: average midpoint stride " << before << " -> "
+                      << averageMidpointStride(simplified) << "\n";
+    }
+
+    toColumns(simplified, simplifiedCols);
+    computeClipped();
+    decimateClipped();
+    if (showWireframe) projectToViewport(wireframeClipped, xmin_w, ymin_w, xmax_w, ymax_w, wireframeProjected);
+    instancesDirty = true;
+    if (!verboseView) return;
+    std::cout << "Segments: " << segments.size() << " input -> " << simplified.size() << " simplified -> "
+              << clipped.count() << " clipped (" << clipped.bytes() << " bytes) -> " << decimated.size() << " drawn\n";
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "View update: " << ms << " ms\n";
+}
+
+// Random segments of length up to maxLen inside [-extent, extent]^2
+void randomSegments(size_t n, double extent, double maxLen, SegmentColumns &cols)
+{
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> pos(-extent, extent), off(-maxLen, maxLen);
+    cols.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        cols.x0[i] = pos(rng); cols.y0[i] = pos(rng);
+        cols.x1[i] = cols.x0[i] + off(rng); cols.y1[i] = cols.y0[i] + off(rng);
+    }
+}
+
+// Seconds per call of fn, best of a few repetitions
+template <typename Fn>
+double bestTime(Fn &&fn, int reps = 5)
+{
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+    }
+    return best;
+}
+
+// View transform + clip: two-pass vs fused vs inverse-transformed window
+void benchmarkViewTransform()
+{
+    const size_t n = 1000000;
+    SegmentColumns cols, tmp;
+    randomSegments(n, 200.0, 20.0, cols);
+    std::vector<Segment> out;
+    out.reserve(n);
+
+    Affine2D rot;
+    rot.m00 = 0.8 * std::cos(0.3); rot.m01 = -0.8 * std::sin(0.3); rot.tx = 5;
+    rot.m10 = 0.8 * std::sin(0.3); rot.m11 =  0.8 * std::cos(0.3); rot.ty = -7;
+    Affine2D zoom;
+    zoom.m00 = 1.5; zoom.m11 = 1.5; zoom.tx = 12; zoom.ty = -3;
+
+    auto rate = [&](double sec) { return double(n) / sec / 1e6; };
+    std::cout << "View transform + clip (" << n << " segments, Mseg/s):\n";
+    double t2 = bestTime([&] { out.clear(); clipColumnsTwoPass(cols, rot, -50, -50, 50, 50, tmp, out); });
+    double tf = bestTime([&] { out.clear(); clipColumnsFused(cols, rot, -50, -50, 50, 50, out); });
+    std::cout << "  rotate:  two-pass " << rate(t2) << ", fused " << rate(tf) << "\n";
+    t2 = bestTime([&] { out.clear(); clipColumnsTwoPass(cols, zoom, -50, -50, 50, 50, tmp, out); });
+    tf = bestTime([&] { out.clear(); clipColumnsFused(cols, zoom, -50, -50, 50, 50, out); });
+    double ti = bestTime([&] { out.clear(); clipColumnsInverseWindow(cols, zoom, -50, -50, 50, 50, out); });
+    std::cout << "  pan/zoom: two-pass " << rate(t2) << ", fused " << rate(tf) << ", inverse window " << rate(ti) << "\n";
+}
+
+// Homogeneous frustum clipping throughput on a CAD-like wireframe, per SIMD level
+void benchmarkHomogeneousClip()
+{
+    HomogeneousColumns in, out;
+    size_t straddling = 0;
+    cubeGridWireframe(40, in);
+    SimdLevel saved = simdLevel;
+    std::cout << "Frustum clip (" << in.size() << " wireframe edges, Mseg/s):\n";
+    for (SimdLevel l : { SimdLevel::Generic, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (l > simdLevelDetected) break;
+        bindSimdLevel(l);
+        double sec = bestTime([&] { clipHomogeneousBatch(in, out, straddling); });
+        std::cout << "  " << simdLevelName(l) << ": " << double(in.size()) / sec / 1e6 << "\n";
+    }
+    bindSimdLevel(saved);
+    std::cout << "  " << out.size() << " visible, " << straddling << " straddling\n";
+}
+
+// Materialized vs lazy clip output: result size and clip + read-back time
+void benchmarkLazyClip()
+{
+    const size_t n = 1000000;
+    SegmentColumns cols;
+    randomSegments(n, 100.0, 20.0, cols);
+    Affine2D identity;
+    std::vector<Segment> eager;
+    eager.reserve(n);
+    ClipResult lazy;
+    volatile double sink = 0.0; // keeps the read-back loops from being optimized out
+
+    double te = bestTime([&] {
+        eager.clear();
+        clipColumnsFused(cols, identity, -50, -50, 50, 50, eager);
+        for (const auto &s : eager) sink = sink + s.a.x + s.b.y;
+    });
+    double tl = bestTime([&] {
+        clipColumnsLazy(cols, identity, -50, -50, 50, 50, lazy);
+        forEachClipped(lazy, cols, identity, [&](const Segment &s) { sink = sink + s.a.x + s.b.y; });
+    });
+    std::cout << "Clip results (" << eager.size() << " visible of " << n << "): materialized "
+              << eager.size() * sizeof(Segment) << " bytes, " << te * 1e3 << " ms; lazy "
+              << lazy.bytes() << " bytes (" << lazy.partial.size() << " partial), " << tl * 1e3 << " ms\n";
+}
+
+// Lazy clip throughput with each classification variant the CPU supports
+void benchmarkCpuDispatch()
+{
+    const size_t n = 1000000;
+    SegmentColumns cols;
+    randomSegments(n, 100.0, 20.0, cols);
+    Affine2D rot;
+    rot.m00 = 0.8 * std::cos(0.3); rot.m01 = -0.8 * std::sin(0.3); rot.tx = 5;
+    rot.m10 = 0.8 * std::sin(0.3); rot.m11 =  0.8 * std::cos(0.3); rot.ty = -7;
+    ClipResult r;
+    std::vector<uint8_t> cls(n);
+    SimdLevel saved = simdLevel;
+    std::cout << "By SIMD level (" << n << " rotated segments, Mseg/s classify / lazy clip):\n";
+    for (SimdLevel l : { SimdLevel::Generic, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+        if (l > simdLevelDetected) break;
+        bindSimdLevel(l);
+        double tc = bestTime([&] { classifySegments(cols, 0, n, rot, -50, -50, 50, 50, cls.data()); });
+        double tl = bestTime([&] { clipColumnsLazy(cols, rot, -50, -50, 50, 50, r); });
+        std::cout << "  " << simdLevelName(l) << ": " << double(n) / tc / 1e6 << " / " << double(n) / tl / 1e6 << "\n";
+    }
+    bindSimdLevel(saved);
+}
+
+// Tile binning: one clip pass per tile vs a single multi-window pass
+void benchmarkTileBinning()
+{
+    const size_t n = 200000;
+    const int nx = 16, ny = 16;
+    SegmentColumns cols;
+    randomSegments(n, 100.0, 10.0, cols);
+    Affine2D identity;
+    ClipResult perTile;
+    TileBins bins;
+    size_t pieces = 0;
+
+    double tPer = bestTime([&] {
+        pieces = 0;
+        for (int ty = 0; ty < ny; ++ty) {
+            for (int tx = 0; tx < nx; ++tx) {
+                double x0 = -100 + tx * 200.0 / nx, y0 = -100 + ty * 200.0 / ny;
+                clipColumnsLazy(cols, identity, x0, y0, x0 + 200.0 / nx, y0 + 200.0 / ny, perTile);
+                pieces += perTile.count();
+            }
+        }
+    }, 2);
+    double tBin = bestTime([&] { clipColumnsToTiles(cols, -100, -100, 100, 100, nx, ny, bins); }, 2);
+    size_t binned = 0;
+    for (const auto &b : bins.bins) binned += b.size();
+    std::cout << "Tile binning (" << n << " segments, " << nx << "x" << ny << " tiles): per-tile clip "
+              << tPer * 1e3 << " ms (" << pieces << " pieces), one-pass " << tBin * 1e3 << " ms ("
+              << binned << " pieces)\n";
+}
+
+// Dedupe on a mesh exported face by face (every interior edge twice, once per
+// adjacent cell, in opposite directions): dedupe time and clip pass before/after
+void benchmarkDedupe()
+{
+    const int gridN = 300;
+    const double cell = 200.0 / gridN;
+    std::vector<Segment> mesh;
+    mesh.reserve(size_t(gridN) * gridN * 4);
+    for (int gy = 0; gy < gridN; ++gy) {
+        for (int gx = 0; gx < gridN; ++gx) {
+            Point c[4] = { { -100 + gx * cell, -100 + gy * cell }, { -100 + (gx + 1) * cell, -100 + gy * cell },
+                           { -100 + (gx + 1) * cell, -100 + (gy + 1) * cell }, { -100 + gx * cell, -100 + (gy + 1) * cell } };
+            for (int e = 0; e < 4; ++e) mesh.push_back({ c[e], c[(e + 1) & 3] });
+        }
+    }
+    SegmentColumns before, after;
+    toColumns(mesh, before);
+    size_t n0 = mesh.size();
+    double td = bestTime([&] { std::vector<Segment> tmp = mesh; dedupeSegments(tmp); }, 2);
+    dedupeSegments(mesh);
+    toColumns(mesh, after);
+    ClipResult r;
+    Affine2D identity;
+    double clipBefore = bestTime([&] { clipColumnsLazy(before, identity, -50, -50, 50, 50, r); }, 3);
+    double clipAfter = bestTime([&] { clipColumnsLazy(after, identity, -50, -50, 50, 50, r); }, 3);
+    std::cout << "Dedupe (" << gridN << "x" << gridN << " mesh): " << n0 << " -> " << mesh.size()
+              << " segments (ratio " << double(mesh.size()) / double(n0) << ") in " << td * 1e3
+              << " ms; clip pass " << clipBefore * 1e3 << " -> " << clipAfter * 1e3 << " ms\n";
+}
+
+void runBenchmarks()
+{
+    benchmarkViewTransform();
+    benchmarkHomogeneousClip();
+    benchmarkLazyClip();
+    benchmarkCpuDispatch();
+    benchmarkTileBinning();
+    benchmarkDedupe();
+}
+
+// Read the segment count and segments from stdin into `segments`
+bool readSegments()
+{
+    int n;
+    std::cout << "Enter number of line segments: ";
+    if (!(std::cin >> n) || n < 0) {
+        std::cerr << "Invalid number of segments. Exiting.\n";
+        return false;
+    }
+
+    segments.clear();
+    std::cout << "Enter each segment as: x0 y0 x1 y1 (space-separated), one per line.\n";
+    for (int i = 0; i < n; ++i) {
+        double x0, y0, x1, y1;
+        if (!(std::cin >> x0 >> y0 >> x1 >> y1)) {
+            std::cerr << "Invalid segment input; expected 4 numbers. Exiting.\n";
+            return false;
+        }
+        segments.push_back({{x0,y0},{x1,y1}});
+    }
+    return true;
+}
+
+// Clean up the input, chain it into polylines and build the LOD pyramid if enabled
+void prepareSegments()
+{
+    // Duplicate / overlap removal (its effect on the clip pass is in the 'b' benchmarks)
+    if (useDedupe && !segments.empty()) {
+        size_t n0 = segments.size();
+        dedupeSegments(segments);
+        std::cout << "Dedupe: " << n0 << " -> " << segments.size() << " segments\n";
+    }
+
+    // Chain segments into polylines; simplification and clipping run in reshape
+    // once the view scale is known
+    buildPolylines();
+
+    // Build the LOD pyramid and map it; fall back to per-view simplification on failure
+    if (useLodPyramid && !segments.empty()) {
+        if (writeLodPyramid(lodFilePath) && openLodPyramid(lodFilePath)) {
+            std::cout << "LOD pyramid written to " << lodFilePath << " (" << lodSize << " bytes)\n";
+        } else {
+            std::cerr << "Could not build LOD pyramid; simplifying per view instead.\n";
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Liang-Barsky Line Clipping Visualization\n";
+    initCpuDispatch();
+    std::cout << "Enter clipping rectangle xmin ymin xmax ymax (space-separated):\n";
+    if (!(std::cin >> xmin_w >> ymin_w >> xmax_w >> ymax_w)) {
+        std::cerr << "Invalid clipping window input. Exiting.\n";
+        return 1;
+    }
+
+    if (xmin_w > xmax_w) std::swap(xmin_w, xmax_w);
+    if (ymin_w > ymax_w) std::swap(ymin_w, ymax_w);
+
+    // Map an existing LOD pyramid; its segments need not be read again
+    bool lodReused = false;
+    if (const char* path = std::getenv("CLIP_LOD_FILE")) {
+        lodFilePath = path;
+        useLodPyramid = true;
+        const char* rebuild = std::getenv("CLIP_LOD_REBUILD");
+        bool forceRebuild = rebuild && *rebuild && std::strcmp(rebuild, "0") != 0;
+        if (!forceRebuild && openLodPyramid(lodFilePath)) {
+            lodReused = true;
+            std::cout << "Using LOD pyramid " << lodFilePath << " (" << lodSize << " bytes); segment input skipped."
+                         " Set CLIP_LOD_REBUILD=1 to rebuild it.\n";
+        }
+    }
+    if (!lodReused) {
+        if (!readSegments()) return 1;
+        prepareSegments();
+    }
+
+    // Initialize GLUT and run main loop
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
+    glutInitWindowSize(winWidth, winHeight);
+    glutCreateWindow("Liang-Barsky Line Clipping");
+
+    // background white
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+#ifdef HAVE_INSTANCED_GL
+    if (useInstancedRendering) {
+        instancedReady = initInstancedRendering();
+        std::cout << (instancedReady ? "Using instanced segment rendering.\n"
+                                     : "GL 3.3 not available; using immediate-mode lines.\n");
+    }
+#endif
+
+    // callbacks
+    glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
+    glutKeyboardFunc(keyboard);
+    glutSpecialFunc(special);
+
+    std::cout << "Press +/- to zoom, arrow keys to pan, r/R to rotate, b to run benchmarks,\n"
+                 "v to print view-update statistics, w to toggle the 3D wireframe,\n"
+                 "ESC or 'q' to quit the visualization window.\n";
+
+    glutMainLoop();
+    return 0;
+}
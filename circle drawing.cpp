@@ -1,163 +1,1508 @@
-// concentric_circles_gradient_fixed.cpp
-// Enhanced colorful concentric rings with smooth gradient & glow effect
-// Fixed compilation/runtime issues and made code robust.
-// Compile:
-//   g++ concentric_circles_gradient_fixed.cpp -o concentric_circles_gradient_fixed -lGL -lGLU -lglut -std=c++17
-
-#include <GL/glut.h>
-#include <cmath>
-#include <algorithm>
-
-// Window size
-const int WINDOW_W = 800;
-const int WINDOW_H = 800;
-
-// Rings parameters
-const int NUM_RINGS = 25;        // number of concentric rings
-const float START_RADIUS = 15.0f; // inner radius (pixels)
-const float RADIUS_STEP = 12.0f;  // radius increment per ring
-const float BASE_THICKNESS = 8.0f; // thickness of each ring (pixels)
-const int SEGMENTS = 360;         // number of segments to approximate a circle (>= 3)
-
-// Constant PI (portable)
-constexpr double PI = 3.14159265358979323846;
-
-// Convert HSV (h in degrees, s and v in [0..1]) to RGB (outputs in [0..1])
-void hsvToRgb(float h, float s, float v, float &r, float &g, float &b) {
-    if (s <= 0.0001f) { r = g = b = v; return; }
-    // wrap hue
-    while (h < 0.0f) h += 360.0f;
-    while (h >= 360.0f) h -= 360.0f;
-
-    float hh = h / 60.0f;
-    int i = static_cast<int>(floor(hh));
-    float ff = hh - i;
-    float p = v * (1.0f - s);
-    float q = v * (1.0f - s * ff);
-    float t = v * (1.0f - s * (1.0f - ff));
-
-    switch (i) {
-        case 0: r = v; g = t; b = p; break;
-        case 1: r = q; g = v; b = p; break;
-        case 2: r = p; g = v; b = t; break;
-        case 3: r = p; g = q; b = v; break;
-        case 4: r = t; g = p; b = v; break;
-        case 5:
-        default: r = v; g = p; b = q; break;
-    }
-}
-
-// Draw a single ring (as a triangle strip) centered at (cx, cy)
-void drawRing(float cx, float cy, float innerR, float outerR,
-              float hue, float sat, float val, float alpha)
-{
-    // Ensure at least 3 segments
-    int segs = std::max(3, SEGMENTS);
-
-    glBegin(GL_TRIANGLE_STRIP);
-    for (int i = 0; i <= segs; ++i) {
-        float theta = static_cast<float>( (2.0 * PI * i) / segs );
-        float c = cosf(theta);
-        float s = sinf(theta);
-
-        // Outer vertex (slightly brighter)
-        float ro, go, bo;
-        hsvToRgb(hue, sat, std::min(1.0f, val + 0.10f), ro, go, bo);
-        glColor4f(ro, go, bo, alpha);
-        glVertex2f(cx + outerR * c, cy + outerR * s);
-
-        // Inner vertex (slightly dimmer)
-        float ri, gi, bi;
-        hsvToRgb(hue, sat, val * 0.85f, ri, gi, bi);
-        glColor4f(ri, gi, bi, alpha);
-        glVertex2f(cx + innerR * c, cy + innerR * s);
-    }
-    glEnd();
-}
-
-void display()
-{
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    float cx = WINDOW_W * 0.5f;
-    float cy = WINDOW_H * 0.5f;
-
-    // Gradient path: warm (pink/red) -> cool (cyan/blue/violet)
-    float startHue = 330.0f; // pink-magenta
-    float endHue   = 210.0f; // blue-cyan
-
-    for (int i = 0; i < NUM_RINGS; ++i) {
-        float innerR = START_RADIUS + i * RADIUS_STEP;
-        float outerR = innerR + BASE_THICKNESS;
-
-        float t = (NUM_RINGS == 1) ? 0.0f : static_cast<float>(i) / (NUM_RINGS - 1);
-
-        // Smooth hue interpolation (you can change easing here if desired)
-        float hue = startHue + t * (endHue - startHue);
-
-        // Slight modulation for richer palette
-        float sat = 0.78f + 0.18f * sinf(t * static_cast<float>(PI)); // 0.6..0.96
-        float val = 0.95f - 0.28f * t; // inner brighter, outer slightly dimmer
-
-        // Transparency for soft blending
-        float alpha = 0.78f + 0.22f * (1.0f - t);
-
-        drawRing(cx, cy, innerR, outerR, hue, sat, val, alpha);
-    }
-
-    glutSwapBuffers();
-}
-
-void reshape(int w, int h)
-{
-    // Keep coordinate system fixed to pixel-like coords for simplicity
-    glViewport(0, 0, w, h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    // Map x: [0..WINDOW_W], y: [0..WINDOW_H]
-    gluOrtho2D(0.0, static_cast<double>(WINDOW_W), 0.0, static_cast<double>(WINDOW_H));
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-}
-
-void keyboard(unsigned char key, int, int)
-{
-    if (key == 27 || key == 'q' || key == 'Q') {
-        // Try to exit politely. If using older GLUT without glutLeaveMainLoop, use exit().
-#if defined(GLUT_API_VERSION) && (GLUT_API_VERSION >= 4)
-        // freeglut provides glutLeaveMainLoop()
-        //glutLeaveMainLoop();
-#else
-        exit(0);
-#endif
-    }
-}
-
-int main(int argc, char** argv)
-{
-    glutInit(&argc, argv);
-
-    // Request double-buffered RGBA window with multisampling if supported
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_MULTISAMPLE);
-    glutInitWindowSize(WINDOW_W, WINDOW_H);
-    glutInitWindowPosition(200, 100);
-    glutCreateWindow("Beautiful Concentric Circles - Fixed");
-
-    // Enable blending and multisampling for smooth, glowing look
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    //glEnable(GL_MULTISAMPLE);
-
-    // Background (dark)
-    glClearColor(0.03f, 0.03f, 0.05f, 1.0f);
-
-    // Callbacks
-    glutDisplayFunc(display);
-    glutReshapeFunc(reshape);
-    glutKeyboardFunc(keyboard);
-
-    // Enter main loop
-    glutMainLoop();
-
-    return 0;
-}
+// concentric_circles_gradient_fixed.cpp
+// Enhanced colorful concentric rings with smooth gradient & glow effect
+// Fixed compilation/runtime issues and made code robust.
+// Compile:
+//   g++ -O2 concentric_circles_gradient_fixed.cpp -o concentric_circles_gradient_fixed -lGL -lGLU -lglut -std=c++17 -pthread
+
+#include "glshader.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Window size
+constexpr int WINDOW_W = 800;
+constexpr int WINDOW_H = 800;
+
+// Rings parameters
+constexpr int NUM_RINGS = 25;        // number of concentric rings
+constexpr float START_RADIUS = 15.0f; // inner radius (pixels)
+constexpr float RADIUS_STEP = 12.0f;  // radius increment per ring
+constexpr float BASE_THICKNESS = 8.0f; // thickness of each ring (pixels)
+constexpr int SEGMENTS = 360;         // number of segments to approximate a circle (>= 3)
+static_assert(SEGMENTS >= 3, "need at least 3 segments per ring");
+
+// Background (dark)
+const float BG_R = 0.03f, BG_G = 0.03f, BG_B = 0.05f;
+
+// Constant PI (portable)
+constexpr double PI = 3.14159265358979323846;
+
+// constexpr sine: reduce to [-pi/2, pi/2] and evaluate the Taylor polynomial
+// up to x^15 (error < 1e-11, far below float precision)
+constexpr double constexprSin(double x)
+{
+    long long k = static_cast<long long>(x / (2.0 * PI));
+    x -= static_cast<double>(k) * 2.0 * PI;        // (-2pi, 2pi)
+    if (x > PI) x -= 2.0 * PI;
+    if (x < -PI) x += 2.0 * PI;                     // [-pi, pi]
+    if (x > PI / 2) x = PI - x;
+    if (x < -PI / 2) x = -PI - x;                   // [-pi/2, pi/2]
+    double x2 = x * x, term = x, sum = x;
+    for (int n = 1; n <= 7; ++n) {
+        term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x) { return constexprSin(x + PI / 2); }
+
+// the truncation error is largest at the ends of the reduced range (about 6e-12)
+static_assert(constexprSin(PI / 2) > 1.0 - 1e-11 && constexprSin(PI / 2) < 1.0 + 1e-11,
+              "constexprSin error bound");
+
+// Per-ring parameters: center, radii and the outer/inner edge colors (RGBA)
+struct RingInstance {
+    float cx, cy, innerR, outerR;
+    float outer[4];
+    float inner[4];
+};
+
+// Draw all rings with one glDrawArraysInstanced call over a shared unit-annulus
+// mesh instead of one immediate-mode strip per ring (falls back when GL < 3.3)
+bool useInstancedRings = true;
+bool instancedReady = false;
+
+// Shade the rings per pixel on the CPU (pure function of the distance to the
+// center) and blit the image instead of rasterizing geometry
+bool useProceduralShading = false;
+std::vector<unsigned char> cpuImage;   // RGBA8, bottom row first (glDrawPixels order)
+bool cpuImageValid = false;
+
+// Rasterize the ring triangle strips on the CPU (half-space rasterizer) and blit
+// the image; uses the same cpuImage as the procedural path
+bool useSoftwareRaster = false;
+bool useSimdQuads = true;   // SSE2 pixel quads in the software rasterizer
+
+// Binary ring mode of the software renderer: pixel-exact integer annuli filled
+// span by span (no triangles, no edge anti-aliasing)
+bool useBinaryRings = false;
+
+// Draw the scene from the compile-time baked vertex buffer
+bool useBakedGeometry = false;
+std::chrono::steady_clock::time_point programStart;
+
+// The scene is static: render it once into an offscreen texture and redraw by
+// drawing that texture. The cache is invalidated when the window size or the
+// rendering mode changes.
+bool useSceneCache = true;
+bool sceneCacheValid = false;
+int windowW = WINDOW_W, windowH = WINDOW_H;   // current window size (set in reshape)
+
+// Convert HSV (h in degrees, s and v in [0..1]) to RGB (outputs in [0..1])
+// constexpr so the ring colors can be baked at compile time
+constexpr void hsvToRgb(float h, float s, float v, float &r, float &g, float &b) {
+    if (s <= 0.0001f) { r = g = b = v; return; }
+    // wrap hue
+    while (h < 0.0f) h += 360.0f;
+    while (h >= 360.0f) h -= 360.0f;
+
+    float hh = h / 60.0f;
+    int i = static_cast<int>(hh); // hh >= 0, so truncation == floor
+    float ff = hh - i;
+    float p = v * (1.0f - s);
+    float q = v * (1.0f - s * ff);
+    float t = v * (1.0f - s * (1.0f - ff));
+
+    switch (i) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        case 5:
+        default: r = v; g = p; b = q; break;
+    }
+}
+
+// Unit circle sampled at angles 2*pi*i/segs, i = 0..segs
+struct UnitCircle {
+    std::vector<float> c, s;
+};
+
+// Rotation recurrence: each point is the previous one multiplied by e^{i*dtheta}
+// (a complex multiply: four multiplies and two adds), so only one sin/cos pair
+// is evaluated. Every RENORM_INTERVAL steps the point is renormalized to unit
+// length, and the last point is pinned to the exact start so the strip closes.
+const int RENORM_INTERVAL = 32;
+
+void unitCircleRecurrence(int segs, UnitCircle &out)
+{
+    const float cd = static_cast<float>(std::cos(2.0 * PI / segs));
+    const float sd = static_cast<float>(std::sin(2.0 * PI / segs));
+    out.c.resize(segs + 1);
+    out.s.resize(segs + 1);
+    float c = 1.0f, s = 0.0f;
+    for (int i = 0; i < segs; ++i) {
+        out.c[i] = c;
+        out.s[i] = s;
+        float nc = c * cd - s * sd;
+        float ns = s * cd + c * sd;
+        c = nc;
+        s = ns;
+        if ((i + 1) % RENORM_INTERVAL == 0) {
+            float inv = 1.0f / std::sqrt(c * c + s * s);
+            c *= inv;
+            s *= inv;
+        }
+    }
+    out.c[segs] = 1.0f;
+    out.s[segs] = 0.0f;
+}
+
+// Reference table evaluated with cosf/sinf per vertex
+void unitCircleTrig(int segs, UnitCircle &out)
+{
+    out.c.resize(segs + 1);
+    out.s.resize(segs + 1);
+    for (int i = 0; i <= segs; ++i) {
+        float theta = static_cast<float>( (2.0 * PI * i) / segs );
+        out.c[i] = cosf(theta);
+        out.s[i] = sinf(theta);
+    }
+}
+
+// Shared unit circle for SEGMENTS, scaled per ring
+const UnitCircle &sharedUnitCircle()
+{
+    static UnitCircle table;
+    if (table.c.empty()) unitCircleRecurrence(std::max(3, SEGMENTS), table);
+    return table;
+}
+
+// Triangle-strip vertex positions (outer, inner, outer, ...) of one ring,
+// appended to xy as x,y pairs
+void generateRingStrip(const RingInstance &r, const UnitCircle &unit, std::vector<float> &xy)
+{
+    const size_t n = unit.c.size();
+    const size_t base = xy.size();
+    xy.resize(base + n * 4);
+    float *out = &xy[base];
+    const float *c = unit.c.data(), *s = unit.s.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[4 * i + 0] = r.cx + r.outerR * c[i];
+        out[4 * i + 1] = r.cy + r.outerR * s[i];
+        out[4 * i + 2] = r.cx + r.innerR * c[i];
+        out[4 * i + 3] = r.cy + r.innerR * s[i];
+    }
+}
+
+// Strips of all rings in the same layout as generateRingStrip per ring, computed
+// across rings: with SSE2 four rings share each angle step, and a 4x4 transpose
+// turns their (outer x, outer y, inner x, inner y) into one 16-byte store per
+// ring. Leftover rings (and builds without SSE2) go through generateRingStrip.
+void generateRingStrips(const std::vector<RingInstance> &rings, const UnitCircle &unit, std::vector<float> &xy)
+{
+    size_t k = 0;
+#ifdef __SSE2__
+    const size_t n = unit.c.size();
+    const size_t base = xy.size();
+    const size_t batched = rings.size() / 4 * 4;
+    xy.resize(base + batched * n * 4);
+    for (; k < batched; k += 4) {
+        const RingInstance *r = &rings[k];
+        const __m128 cx = _mm_set_ps(r[3].cx, r[2].cx, r[1].cx, r[0].cx);
+        const __m128 cy = _mm_set_ps(r[3].cy, r[2].cy, r[1].cy, r[0].cy);
+        const __m128 ro = _mm_set_ps(r[3].outerR, r[2].outerR, r[1].outerR, r[0].outerR);
+        const __m128 ri = _mm_set_ps(r[3].innerR, r[2].innerR, r[1].innerR, r[0].innerR);
+        float *out = &xy[base + k * n * 4];
+        for (size_t i = 0; i < n; ++i) {
+            const __m128 c = _mm_set1_ps(unit.c[i]), s = _mm_set1_ps(unit.s[i]);
+            __m128 ox = _mm_add_ps(cx, _mm_mul_ps(ro, c)), oy = _mm_add_ps(cy, _mm_mul_ps(ro, s));
+            __m128 ix = _mm_add_ps(cx, _mm_mul_ps(ri, c)), iy = _mm_add_ps(cy, _mm_mul_ps(ri, s));
+            _MM_TRANSPOSE4_PS(ox, oy, ix, iy);   // now one row per ring
+            _mm_storeu_ps(out + 4 * i, ox);
+            _mm_storeu_ps(out + (n + i) * 4, oy);
+            _mm_storeu_ps(out + (2 * n + i) * 4, ix);
+            _mm_storeu_ps(out + (3 * n + i) * 4, iy);
+        }
+    }
+#endif
+    for (; k < rings.size(); ++k) generateRingStrip(rings[k], unit, xy);
+}
+
+// Draw a single ring (as a triangle strip) centered at (r.cx, r.cy)
+void drawRing(const RingInstance &r)
+{
+    const UnitCircle &unit = sharedUnitCircle();
+
+    glBegin(GL_TRIANGLE_STRIP);
+    for (size_t i = 0; i < unit.c.size(); ++i) {
+        float c = unit.c[i];
+        float s = unit.s[i];
+
+        // Outer vertex (slightly brighter)
+        glColor4fv(r.outer);
+        glVertex2f(r.cx + r.outerR * c, r.cy + r.outerR * s);
+
+        // Inner vertex (slightly dimmer)
+        glColor4fv(r.inner);
+        glVertex2f(r.cx + r.innerR * c, r.cy + r.innerR * s);
+    }
+    glEnd();
+}
+
+// Parameters of ring i of the concentric gradient scene (constexpr so the
+// geometry can also be baked at compile time)
+constexpr RingInstance sceneRing(int i)
+{
+    float cx = WINDOW_W * 0.5f;
+    float cy = WINDOW_H * 0.5f;
+
+    // Gradient path: warm (pink/red) -> cool (cyan/blue/violet)
+    float startHue = 330.0f; // pink-magenta
+    float endHue   = 210.0f; // blue-cyan
+
+    float innerR = START_RADIUS + i * RADIUS_STEP;
+    float outerR = innerR + BASE_THICKNESS;
+
+    float t = (NUM_RINGS == 1) ? 0.0f : static_cast<float>(i) / (NUM_RINGS - 1);
+
+    // Smooth hue interpolation (you can change easing here if desired)
+    float hue = startHue + t * (endHue - startHue);
+
+    // Slight modulation for richer palette
+    float sat = 0.78f + 0.18f * static_cast<float>(constexprSin(t * PI)); // 0.6..0.96
+    float val = 0.95f - 0.28f * t; // inner brighter, outer slightly dimmer
+
+    // Transparency for soft blending
+    float alpha = 0.78f + 0.22f * (1.0f - t);
+
+    // Outer edge slightly brighter, inner edge slightly dimmer (as in drawRing)
+    RingInstance ring{ cx, cy, innerR, outerR, {}, {} };
+    hsvToRgb(hue, sat, std::min(1.0f, val + 0.10f), ring.outer[0], ring.outer[1], ring.outer[2]);
+    hsvToRgb(hue, sat, val * 0.85f, ring.inner[0], ring.inner[1], ring.inner[2]);
+    ring.outer[3] = ring.inner[3] = alpha;
+    return ring;
+}
+
+// Ring parameters of the concentric gradient scene
+void buildSceneRings(std::vector<RingInstance> &rings)
+{
+    rings.clear();
+    for (int i = 0; i < NUM_RINGS; ++i) rings.push_back(sceneRing(i));
+}
+
+// Interleaved scene vertex buffer: per ring one triangle strip of
+// RING_STRIP_VERTICES vertices (outer, inner, ...), each x, y, r, g, b, a
+constexpr int RING_STRIP_VERTICES = 2 * (SEGMENTS + 1);
+constexpr int VERTEX_FLOATS = 6;
+constexpr int SCENE_VERTEX_FLOATS = NUM_RINGS * RING_STRIP_VERTICES * VERTEX_FLOATS;
+
+struct RingVertexBuffer {
+    float data[SCENE_VERTEX_FLOATS];
+};
+
+// Generate the whole scene buffer at compile time
+constexpr RingVertexBuffer bakeRingVertices()
+{
+    RingVertexBuffer buf{};
+    int k = 0;
+    for (int ring = 0; ring < NUM_RINGS; ++ring) {
+        RingInstance r = sceneRing(ring);
+        for (int i = 0; i <= SEGMENTS; ++i) {
+            double theta = (2.0 * PI * i) / SEGMENTS;
+            float c = static_cast<float>(constexprCos(theta));
+            float s = static_cast<float>(constexprSin(theta));
+            const float *colors[2] = { r.outer, r.inner };
+            const float radii[2] = { r.outerR, r.innerR };
+            for (int e = 0; e < 2; ++e) {
+                buf.data[k++] = r.cx + radii[e] * c;
+                buf.data[k++] = r.cy + radii[e] * s;
+                for (int ch = 0; ch < 4; ++ch) buf.data[k++] = colors[e][ch];
+            }
+        }
+    }
+    return buf;
+}
+
+// Lives in the binary's read-only data; no geometry work at startup
+constexpr RingVertexBuffer BAKED_RING_VERTICES = bakeRingVertices();
+
+// Runtime path (for non-constant parameters): same layout built from the rings
+void buildRingVertexBuffer(const std::vector<RingInstance> &rings, std::vector<float> &out)
+{
+    const UnitCircle &unit = sharedUnitCircle();
+    out.clear();
+    out.reserve(rings.size() * unit.c.size() * 2 * VERTEX_FLOATS);
+    for (const auto &r : rings) {
+        for (size_t i = 0; i < unit.c.size(); ++i) {
+            out.insert(out.end(), { r.cx + r.outerR * unit.c[i], r.cy + r.outerR * unit.s[i] });
+            out.insert(out.end(), r.outer, r.outer + 4);
+            out.insert(out.end(), { r.cx + r.innerR * unit.c[i], r.cy + r.innerR * unit.s[i] });
+            out.insert(out.end(), r.inner, r.inner + 4);
+        }
+    }
+}
+
+// Draw an interleaved ring buffer with client-side vertex arrays
+void drawInterleavedRings(const float *data, int numRings)
+{
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, VERTEX_FLOATS * sizeof(float), data);
+    glColorPointer(4, GL_FLOAT, VERTEX_FLOATS * sizeof(float), data + 2);
+    for (int ring = 0; ring < numRings; ++ring)
+        glDrawArrays(GL_TRIANGLE_STRIP, ring * RING_STRIP_VERTICES, RING_STRIP_VERTICES);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// Immediate-mode path: one triangle strip per ring
+void drawRingsImmediate(const std::vector<RingInstance> &rings)
+{
+    for (const auto &r : rings) drawRing(r);
+}
+
+#ifdef HAVE_INSTANCED_GL
+GLuint ringProgram = 0;
+GLuint unitRingVbo = 0, ringInstanceVbo = 0;
+GLsizei unitRingVertices = 0;
+
+// unit.xy = direction on the unit circle, unit.z = 1 for the outer edge, 0 for the inner
+const char* ringVertexSrc = R"(#version 130
+in vec3 unit;
+in vec4 ring;
+in vec4 outerColor;
+in vec4 innerColor;
+uniform vec2 viewport;
+out vec4 vColor;
+void main() {
+    float r = mix(ring.z, ring.w, unit.z);
+    vec2 p = ring.xy + r * unit.xy;
+    gl_Position = vec4(p / viewport * 2.0 - 1.0, 0.0, 1.0);
+    vColor = mix(innerColor, outerColor, unit.z);
+}
+)";
+
+const char* ringFragmentSrc = R"(#version 130
+in vec4 vColor;
+out vec4 fragColor;
+void main() {
+    fragColor = vColor;
+}
+)";
+
+// Needs a current GL context; returns false if GL 3.3 features are missing
+bool initInstancedRings()
+{
+    if (!glVersionAtLeast(3, 3)) return false;
+
+    ringProgram = linkProgram(ringVertexSrc, ringFragmentSrc, { "unit", "ring", "outerColor", "innerColor" });
+    if (!ringProgram) return false;
+
+    // shared unit annulus, same vertex order as drawRing
+    const UnitCircle &unit = sharedUnitCircle();
+    std::vector<float> mesh;
+    for (size_t i = 0; i < unit.c.size(); ++i)
+        mesh.insert(mesh.end(), { unit.c[i], unit.s[i], 1.0f,  unit.c[i], unit.s[i], 0.0f });
+    unitRingVertices = static_cast<GLsizei>(mesh.size() / 3);
+    glGenBuffers(1, &unitRingVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, unitRingVbo);
+    glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &ringInstanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+// Upload per-ring attributes and draw every ring in one call
+void drawRingsInstanced(const std::vector<RingInstance> &rings)
+{
+    if (rings.empty()) return;
+    glBindBuffer(GL_ARRAY_BUFFER, ringInstanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, rings.size() * sizeof(RingInstance), rings.data(), GL_STREAM_DRAW);
+
+    glUseProgram(ringProgram);
+    glUniform2f(glGetUniformLocation(ringProgram, "viewport"), float(WINDOW_W), float(WINDOW_H));
+
+    const GLsizei stride = sizeof(RingInstance);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(RingInstance, cx)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(RingInstance, outer)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(RingInstance, inner)));
+    for (GLuint a = 1; a <= 3; ++a) {
+        glEnableVertexAttribArray(a);
+        glVertexAttribDivisor(a, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, unitRingVbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, unitRingVertices, static_cast<GLsizei>(rings.size()));
+
+    for (GLuint a = 0; a <= 3; ++a) {
+        glVertexAttribDivisor(a, 0);
+        glDisableVertexAttribArray(a);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(0);
+}
+#endif
+
+void drawRings(const std::vector<RingInstance> &rings)
+{
+#ifdef HAVE_INSTANCED_GL
+    if (useInstancedRings && instancedReady) {
+        drawRingsInstanced(rings);
+        return;
+    }
+#endif
+    drawRingsImmediate(rings);
+}
+
+// Persistent worker threads for the CPU renderers, started on first use so a
+// frame does not pay for creating threads. run(count, fn) calls fn(i) for every
+// i in [0, count) on the workers and the calling thread, and returns when all
+// calls are done.
+class WorkerPool {
+public:
+    static WorkerPool &instance()
+    {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    void run(int count, const std::function<void(int)> &fn)
+    {
+        if (threads.empty()) {
+            for (int i = 0; i < count; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobSize = count;
+            next = 0;
+            active = static_cast<int>(threads.size());
+            ++generation;
+        }
+        wake.notify_all();
+        for (int i = next++; i < count; i = next++) fn(i);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return active == 0; });
+        job = nullptr;
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &t : threads) t.join();
+    }
+
+private:
+    WorkerPool()
+    {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < n; ++i) threads.emplace_back([this] { workerLoop(); });
+    }
+
+    void workerLoop()
+    {
+        unsigned seen = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            const std::function<void(int)> &fn = *job;
+            const int count = jobSize;
+            lock.unlock();
+            for (int i = next++; i < count; i = next++) fn(i);
+            lock.lock();
+            if (--active == 0) done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)> *job = nullptr;
+    int jobSize = 0;
+    std::atomic<int> next{ 0 };
+    int active = 0;            // workers that have not finished the current job
+    unsigned generation = 0;   // bumped for every job
+    bool stop = false;
+};
+
+// Integral over t in [x0, x1] of clamp(y, -s(t), s(t)) with s(t) = sqrt(R^2 - t^2)
+// (0 for |t| > R): the signed area of the disk of radius R about the origin
+// between the x axis and the line Y = y, over that column range
+double diskColumnArea(double R, double x0, double x1, double y)
+{
+    double a = std::max(x0, -R), b = std::min(x1, R);
+    if (a >= b) return 0.0;
+    auto G = [R](double t) {   // antiderivative of s(t)
+        return 0.5 * (t * std::sqrt(std::max(R * R - t * t, 0.0)) + R * R * std::asin(std::min(std::max(t / R, -1.0), 1.0)));
+    };
+    double c = std::sqrt(std::max(R * R - y * y, 0.0));   // s(t) > |y| exactly for |t| < c
+    double mid = std::max(std::min(b, c) - std::max(a, -c), 0.0);
+    double capped = 0.0;                                  // integral of s where s(t) <= |y|
+    if (a < -c) capped += G(std::min(b, -c)) - G(a);
+    if (b > c) capped += G(b) - G(std::max(a, c));
+    return y * mid + (y < 0.0 ? -capped : capped);
+}
+
+// Exact area of the disk of radius R about the origin inside [x0, x1] x [y0, y1]
+inline double diskRectArea(double R, double x0, double x1, double y0, double y1)
+{
+    return diskColumnArea(R, x0, x1, y1) - diskColumnArea(R, x0, x1, y0);
+}
+
+// A pixel square lies within half a diagonal of its center, so it can only be cut
+// by ring edges closer than this; with gaps at least this wide it also touches
+// at most one ring, which makes the nearest-ring coverage below exact
+constexpr float PIXEL_HALF_DIAGONAL = 0.70711f;
+static_assert(RADIUS_STEP - BASE_THICKNESS >= 2 * PIXEL_HALF_DIAGONAL && BASE_THICKNESS >= 2 * PIXEL_HALF_DIAGONAL,
+              "procedural coverage assumes a pixel overlaps at most one ring edge pair");
+
+// Procedural ring image: for each pixel compute the radius, pick the nearest ring
+// (gap boundaries halfway between rings), its exact area coverage of the pixel
+// square and the radial color gradient, and blend over the background like
+// GL_SRC_ALPHA. Pixels farther than half a diagonal from both edges are fully
+// inside or outside; only the ones near an edge evaluate the analytic
+// disk / square intersection (diskRectArea) for that edge.
+// The radius / classification pass runs four pixels at a time with SSE2 (scalar
+// loop otherwise); edge coverage, color lookup and blend are scalar. Bands of
+// rows are shaded on the shared worker pool.
+void shadeRingsProcedural(std::vector<unsigned char> &img, int w, int h)
+{
+    std::vector<RingInstance> rings;
+    buildSceneRings(rings);
+    img.resize(size_t(w) * h * 4);
+    if (rings.empty()) return;
+
+    const float cx = rings[0].cx, cy = rings[0].cy;
+    const float gapHalf = 0.5f * (RADIUS_STEP - BASE_THICKNESS);
+    const float maxRing = static_cast<float>(NUM_RINGS - 1);
+    const int bandRows = 16;
+
+    auto shadeBand = [&](int band) {
+        std::vector<float> cover(w), frac(w);
+        std::vector<int> index(w);
+        const int y1 = std::min(h, (band + 1) * bandRows);
+        for (int y = band * bandRows; y < y1; ++y) {
+            const float dy = y + 0.5f - cy;
+            int x = 0;
+#ifdef __SSE2__
+            const __m128 vdy2 = _mm_set1_ps(dy * dy), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+            const __m128 start = _mm_set1_ps(START_RADIUS), edge = _mm_set1_ps(PIXEL_HALF_DIAGONAL);
+            const __m128 step = _mm_set1_ps(RADIUS_STEP), thick = _mm_set1_ps(BASE_THICKNESS);
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)), minusOne = _mm_set1_ps(-1.0f);
+            for (; x + 4 <= w; x += 4) {
+                __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(x + 0.5f)),
+                                       _mm_set1_ps(cx));
+                __m128 r = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), vdy2));
+                // clamped to >= 0 first, so truncation is the floor
+                __m128 k = _mm_div_ps(_mm_add_ps(_mm_sub_ps(r, start), _mm_set1_ps(gapHalf)), step);
+                __m128i ki = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(k, zero), _mm_set1_ps(maxRing)));
+                __m128 inner = _mm_add_ps(start, _mm_mul_ps(_mm_cvtepi32_ps(ki), step));
+                __m128 outer = _mm_add_ps(inner, thick);
+                // 1 inside the ring, 0 outside, -1 when an edge passes through the pixel
+                __m128 nearEdge = _mm_or_ps(_mm_cmplt_ps(_mm_and_ps(_mm_sub_ps(r, inner), absMask), edge),
+                                            _mm_cmplt_ps(_mm_and_ps(_mm_sub_ps(r, outer), absMask), edge));
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(r, inner), _mm_cmplt_ps(r, outer)), one);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(&index[x]), ki);
+                _mm_storeu_ps(&cover[x], _mm_or_ps(_mm_and_ps(nearEdge, minusOne), _mm_andnot_ps(nearEdge, inside)));
+                _mm_storeu_ps(&frac[x], _mm_min_ps(_mm_max_ps(_mm_div_ps(_mm_sub_ps(r, inner), thick), zero), one));
+            }
+#endif
+            for (; x < w; ++x) {
+                float dx = x + 0.5f - cx;
+                float r = std::sqrt(dx * dx + dy * dy);
+                float k = std::floor((r - START_RADIUS + gapHalf) / RADIUS_STEP);
+                k = std::min(std::max(k, 0.0f), maxRing);
+                float inner = START_RADIUS + k * RADIUS_STEP;
+                float outer = inner + BASE_THICKNESS;
+                bool nearEdge = std::fabs(r - inner) < PIXEL_HALF_DIAGONAL || std::fabs(r - outer) < PIXEL_HALF_DIAGONAL;
+                index[x] = static_cast<int>(k);
+                cover[x] = nearEdge ? -1.0f : (r > inner && r < outer ? 1.0f : 0.0f);
+                frac[x] = std::min(std::max((r - inner) / BASE_THICKNESS, 0.0f), 1.0f);
+            }
+            unsigned char *row = &img[size_t(y) * w * 4];
+            for (x = 0; x < w; ++x) {
+                const RingInstance &ring = rings[index[x]];
+                if (cover[x] < 0.0f) {
+                    // pixel square relative to the center; a disk far from the pixel covers it fully or not at all
+                    double px0 = x - cx, py0 = y - cy;
+                    auto diskCover = [&](double R) {
+                        double d = std::sqrt((px0 + 0.5) * (px0 + 0.5) + (py0 + 0.5) * (py0 + 0.5)) - R;
+                        if (std::fabs(d) >= PIXEL_HALF_DIAGONAL) return d < 0.0 ? 1.0 : 0.0;
+                        return diskRectArea(R, px0, px0 + 1.0, py0, py0 + 1.0);
+                    };
+                    double inner = START_RADIUS + index[x] * RADIUS_STEP;
+                    cover[x] = static_cast<float>(std::min(std::max(diskCover(inner + BASE_THICKNESS) - diskCover(inner),
+                                                                    0.0), 1.0));
+                }
+                float t = frac[x];
+                float a = (ring.inner[3] + t * (ring.outer[3] - ring.inner[3])) * cover[x];
+                float rgb[3];
+                for (int c = 0; c < 3; ++c) rgb[c] = ring.inner[c] + t * (ring.outer[c] - ring.inner[c]);
+                row[4 * x + 0] = static_cast<unsigned char>(255.0f * (BG_R + a * (rgb[0] - BG_R)) + 0.5f);
+                row[4 * x + 1] = static_cast<unsigned char>(255.0f * (BG_G + a * (rgb[1] - BG_G)) + 0.5f);
+                row[4 * x + 2] = static_cast<unsigned char>(255.0f * (BG_B + a * (rgb[2] - BG_B)) + 0.5f);
+                row[4 * x + 3] = 255;
+            }
+        }
+    };
+
+    WorkerPool::instance().run((h + bandRows - 1) / bandRows, shadeBand);
+}
+
+// ---------------- Software triangle rasterizer ----------------
+// Half-space rasterizer for the interleaved strip buffers (x, y, r, g, b, a).
+// Vertices snap to 28.4 fixed point; each edge is E = A*X + B*Y + C, evaluated
+// at pixel centers. Triangles are binned into 64x64 screen tiles and tiles are
+// shaded in parallel, each keeping submission order so GL_SRC_ALPHA blending
+// matches the GL paths. Inside a tile the triangle is walked in 8x8 blocks:
+// blocks outside an edge are rejected, blocks inside all three edges are filled
+// without edge tests, and only partial blocks test pixels (4 at a time).
+const int SUBPIXEL_BITS = 4;
+const int SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+const int RASTER_TILE = 64;
+const int RASTER_BLOCK = 8;
+
+struct RasterTriangle {
+    int64_t A[3], B[3], C[3];   // edge functions, > 0 inside (counter-clockwise)
+    int32_t bias[3];            // 0 for top-left edges, -1 otherwise
+    int minX, minY, maxX, maxY; // pixel bounding box (inclusive, unclipped)
+    float ox, oy;               // position of vertex 0 (color plane origin)
+    float c0[4], dcdx[4], dcdy[4];  // Gouraud planes for r, g, b, a
+};
+
+// Triangle setup; returns false for degenerate (zero-area) triangles
+bool setupTriangle(const float *v0, const float *v1, const float *v2, RasterTriangle &t)
+{
+    const float *v[3] = { v0, v1, v2 };
+    int64_t X[3], Y[3];
+    for (int i = 0; i < 3; ++i) {
+        X[i] = std::llround(v[i][0] * SUBPIXEL_ONE);
+        Y[i] = std::llround(v[i][1] * SUBPIXEL_ONE);
+    }
+    int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+    if (area == 0) return false;
+    if (area < 0) {   // strips alternate winding: make every triangle counter-clockwise
+        std::swap(v[1], v[2]);
+        std::swap(X[1], X[2]);
+        std::swap(Y[1], Y[2]);
+    }
+    for (int e = 0; e < 3; ++e) {
+        int a = e, b = (e + 1) % 3;
+        t.A[e] = Y[a] - Y[b];
+        t.B[e] = X[b] - X[a];
+        t.C[e] = -(t.A[e] * X[a] + t.B[e] * Y[a]);
+        bool topLeft = t.A[e] > 0 || (t.A[e] == 0 && t.B[e] < 0);
+        t.bias[e] = topLeft ? 0 : -1;
+    }
+    t.minX = static_cast<int>(std::min({ X[0], X[1], X[2] }) >> SUBPIXEL_BITS);
+    t.minY = static_cast<int>(std::min({ Y[0], Y[1], Y[2] }) >> SUBPIXEL_BITS);
+    t.maxX = static_cast<int>(std::max({ X[0], X[1], X[2] }) >> SUBPIXEL_BITS);
+    t.maxY = static_cast<int>(std::max({ Y[0], Y[1], Y[2] }) >> SUBPIXEL_BITS);
+
+    // color planes from the snapped positions
+    float px[3], py[3];
+    for (int i = 0; i < 3; ++i) {
+        px[i] = static_cast<float>(X[i]) / SUBPIXEL_ONE;
+        py[i] = static_cast<float>(Y[i]) / SUBPIXEL_ONE;
+    }
+    float e1x = px[1] - px[0], e1y = py[1] - py[0], e2x = px[2] - px[0], e2y = py[2] - py[0];
+    float inv = 1.0f / (e1x * e2y - e2x * e1y);
+    t.ox = px[0];
+    t.oy = py[0];
+    for (int ch = 0; ch < 4; ++ch) {
+        float d1 = v[1][2 + ch] - v[0][2 + ch], d2 = v[2][2 + ch] - v[0][2 + ch];
+        t.c0[ch] = v[0][2 + ch];
+        t.dcdx[ch] = (d1 * e2y - d2 * e1y) * inv;
+        t.dcdy[ch] = (d2 * e1x - d1 * e2x) * inv;
+    }
+    return true;
+}
+
+// Tile color buffer: planar float RGB, RASTER_TILE x RASTER_TILE
+struct RasterTile {
+    float rgb[3][RASTER_TILE * RASTER_TILE];
+};
+
+// Per-triangle steps for walking 8x8 blocks; the lane offsets of the two 4-pixel
+// quads of a block row are precomputed so SIMD and scalar results match exactly
+struct BlockSteps {
+    int64_t stepX[3], stepY[3];   // edge change per pixel in x / y
+#ifdef __SSE2__
+    __m128i laneE[2][3];          // {0..3} * stepX, {4..7} * stepX
+    __m128 laneC[2][4];           // same for the color planes
+#endif
+};
+
+void setupBlockSteps(const RasterTriangle &t, BlockSteps &st)
+{
+    for (int k = 0; k < 3; ++k) {
+        st.stepX[k] = t.A[k] * SUBPIXEL_ONE;
+        st.stepY[k] = t.B[k] * SUBPIXEL_ONE;
+    }
+#ifdef __SSE2__
+    for (int q = 0; q < 2; ++q) {
+        int l = 4 * q;
+        for (int k = 0; k < 3; ++k) {
+            // a partial edge stays within 32 bits over the block, so its steps do too
+            int32_t sx = static_cast<int32_t>(st.stepX[k]);
+            st.laneE[q][k] = _mm_setr_epi32(l * sx, (l + 1) * sx, (l + 2) * sx, (l + 3) * sx);
+        }
+        for (int ch = 0; ch < 4; ++ch)
+            st.laneC[q][ch] = _mm_setr_ps(l * t.dcdx[ch], (l + 1) * t.dcdx[ch], (l + 2) * t.dcdx[ch], (l + 3) * t.dcdx[ch]);
+    }
+#endif
+}
+
+// Blend one 8x8 block at screen (bx, by), tile-local (lx, ly). partial selects the
+// edges that still need per-pixel tests; e holds their biased values at the
+// block's first pixel (they change sign inside the block, so they fit 32 bits).
+void shadeBlock(RasterTile &tile, const RasterTriangle &t, const BlockSteps &st,
+                int bx, int by, int lx, int ly, unsigned partial, const int32_t *e)
+{
+    float c[4];   // colors at the block's first pixel center
+    for (int ch = 0; ch < 4; ++ch)
+        c[ch] = t.c0[ch] + t.dcdx[ch] * (bx + 0.5f - t.ox) + t.dcdy[ch] * (by + 0.5f - t.oy);
+    int32_t stepX[3], stepY[3];
+    for (int k = 0; k < 3; ++k) {
+        stepX[k] = static_cast<int32_t>(st.stepX[k]);
+        stepY[k] = static_cast<int32_t>(st.stepY[k]);
+    }
+
+    for (int row = 0; row < RASTER_BLOCK; ++row) {
+        int32_t rowE[3];
+        for (int k = 0; k < 3; ++k) rowE[k] = (partial & (1u << k)) ? e[k] + row * stepY[k] : 0;
+        const int off = (ly + row) * RASTER_TILE + lx;
+        float *dst[3] = { &tile.rgb[0][off], &tile.rgb[1][off], &tile.rgb[2][off] };
+#ifdef __SSE2__
+        if (useSimdQuads) {
+            // coverage of both quads first: thin triangles leave most block rows empty
+            const __m128i minusOne = _mm_set1_epi32(-1);
+            __m128i inside[2] = { minusOne, minusOne };
+            int covered = 0;
+            for (int q = 0; q < 2; ++q) {
+                for (int k = 0; k < 3; ++k)
+                    if (partial & (1u << k))
+                        inside[q] = _mm_and_si128(inside[q], _mm_cmpgt_epi32(
+                            _mm_add_epi32(_mm_set1_epi32(rowE[k]), st.laneE[q][k]), minusOne));
+                covered |= _mm_movemask_ps(_mm_castsi128_ps(inside[q])) << (4 * q);
+            }
+            if (!covered) continue;
+            for (int q = 0; q < 2; ++q) {
+                if (!((covered >> (4 * q)) & 0xF)) continue;
+                // zero alpha leaves uncovered pixels unchanged
+                __m128 a = _mm_and_ps(_mm_castsi128_ps(inside[q]),
+                                      _mm_add_ps(_mm_set1_ps(c[3] + row * t.dcdy[3]), st.laneC[q][3]));
+                for (int ch = 0; ch < 3; ++ch) {
+                    __m128 col = _mm_add_ps(_mm_set1_ps(c[ch] + row * t.dcdy[ch]), st.laneC[q][ch]);
+                    __m128 d = _mm_loadu_ps(dst[ch] + 4 * q);
+                    _mm_storeu_ps(dst[ch] + 4 * q, _mm_add_ps(d, _mm_mul_ps(a, _mm_sub_ps(col, d))));
+                }
+            }
+            continue;
+        }
+#endif
+        for (int i = 0; i < RASTER_BLOCK; ++i) {
+            bool inside = true;
+            for (int k = 0; k < 3; ++k)
+                if ((partial & (1u << k)) && rowE[k] + i * stepX[k] < 0) inside = false;
+            if (!inside) continue;
+            float a = (c[3] + row * t.dcdy[3]) + i * t.dcdx[3];
+            for (int ch = 0; ch < 3; ++ch) {
+                float col = (c[ch] + row * t.dcdy[ch]) + i * t.dcdx[ch];
+                dst[ch][i] = dst[ch][i] + a * (col - dst[ch][i]);
+            }
+        }
+    }
+}
+
+// Rasterize triangle t into the tile at screen origin (tx, ty)
+void rasterizeInTile(RasterTile &tile, const RasterTriangle &t, int tx, int ty)
+{
+    int bx0 = std::max(t.minX, tx) & ~(RASTER_BLOCK - 1);
+    int by0 = std::max(t.minY, ty) & ~(RASTER_BLOCK - 1);
+    int bx1 = std::min(t.maxX, tx + RASTER_TILE - 1);
+    int by1 = std::min(t.maxY, ty + RASTER_TILE - 1);
+    BlockSteps st;
+    setupBlockSteps(t, st);
+
+    // offsets from a block's first pixel to its lowest / highest corner, per edge
+    const int last = RASTER_BLOCK - 1;
+    int64_t toLo[3], toHi[3];
+    for (int k = 0; k < 3; ++k) {
+        toLo[k] = std::min<int64_t>(0, last * st.stepX[k]) + std::min<int64_t>(0, last * st.stepY[k]);
+        toHi[k] = std::max<int64_t>(0, last * st.stepX[k]) + std::max<int64_t>(0, last * st.stepY[k]);
+    }
+    for (int by = by0; by <= by1; by += RASTER_BLOCK) {
+        for (int bx = bx0; bx <= bx1; bx += RASTER_BLOCK) {
+            // biased edge values at the block's first pixel center: reject the block
+            // if one edge is negative at every corner, skip tests of edges positive at all
+            int32_t e[3] = { 0, 0, 0 };
+            unsigned partial = 0;
+            bool reject = false;
+            for (int k = 0; k < 3 && !reject; ++k) {
+                int64_t e0 = t.A[k] * (int64_t(bx) * SUBPIXEL_ONE + SUBPIXEL_ONE / 2) +
+                             t.B[k] * (int64_t(by) * SUBPIXEL_ONE + SUBPIXEL_ONE / 2) + t.C[k] + t.bias[k];
+                if (e0 + toHi[k] < 0) reject = true;
+                else if (e0 + toLo[k] < 0) {
+                    partial |= 1u << k;
+                    e[k] = static_cast<int32_t>(e0);
+                }
+            }
+            if (!reject) shadeBlock(tile, t, st, bx, by, bx - tx, by - ty, partial, e);
+        }
+    }
+}
+
+// Rasterize numStrips triangle strips of stripVertices interleaved vertices
+// into an RGBA8 image (bottom row first) over the scene background
+void rasterizeStripsSoftware(const float *data, int numStrips, int stripVertices,
+                             std::vector<unsigned char> &img, int w, int h)
+{
+    img.resize(size_t(w) * h * 4);
+    std::vector<RasterTriangle> tris;
+    tris.reserve(size_t(numStrips) * std::max(0, stripVertices - 2));
+    for (int s = 0; s < numStrips; ++s) {
+        const float *v = data + size_t(s) * stripVertices * VERTEX_FLOATS;
+        for (int i = 0; i + 2 < stripVertices; ++i) {
+            RasterTriangle t;
+            if (setupTriangle(v + i * VERTEX_FLOATS, v + (i + 1) * VERTEX_FLOATS, v + (i + 2) * VERTEX_FLOATS, t))
+                tris.push_back(t);
+        }
+    }
+
+    // bin triangles (in submission order) into the tiles their bounding box touches
+    const int tilesX = (w + RASTER_TILE - 1) / RASTER_TILE, tilesY = (h + RASTER_TILE - 1) / RASTER_TILE;
+    std::vector<std::vector<uint32_t>> bins(size_t(tilesX) * tilesY);
+    for (uint32_t i = 0; i < tris.size(); ++i) {
+        const RasterTriangle &t = tris[i];
+        int x0 = std::max(t.minX, 0) / RASTER_TILE, x1 = std::min(t.maxX, w - 1) / RASTER_TILE;
+        int y0 = std::max(t.minY, 0) / RASTER_TILE, y1 = std::min(t.maxY, h - 1) / RASTER_TILE;
+        if (t.maxX < 0 || t.maxY < 0 || t.minX >= w || t.minY >= h) continue;
+        for (int ty = y0; ty <= y1; ++ty)
+            for (int tx = x0; tx <= x1; ++tx) bins[size_t(ty) * tilesX + tx].push_back(i);
+    }
+
+    auto shadeTile = [&](int idx) {
+        thread_local RasterTile tile;   // 48 KB, one per pool thread
+        int tx = (idx % tilesX) * RASTER_TILE, ty = (idx / tilesX) * RASTER_TILE;
+        std::fill(tile.rgb[0], tile.rgb[0] + RASTER_TILE * RASTER_TILE, BG_R);
+        std::fill(tile.rgb[1], tile.rgb[1] + RASTER_TILE * RASTER_TILE, BG_G);
+        std::fill(tile.rgb[2], tile.rgb[2] + RASTER_TILE * RASTER_TILE, BG_B);
+        for (uint32_t i : bins[idx]) rasterizeInTile(tile, tris[i], tx, ty);
+        for (int ly = 0; ly < RASTER_TILE && ty + ly < h; ++ly) {
+            unsigned char *row = &img[(size_t(ty + ly) * w + tx) * 4];
+            for (int lx = 0; lx < RASTER_TILE && tx + lx < w; ++lx) {
+                for (int ch = 0; ch < 3; ++ch) {
+                    float c = std::min(std::max(tile.rgb[ch][ly * RASTER_TILE + lx], 0.0f), 1.0f);
+                    row[4 * lx + ch] = static_cast<unsigned char>(255.0f * c + 0.5f);
+                }
+                row[4 * lx + 3] = 255;
+            }
+        }
+    };
+    WorkerPool::instance().run(tilesX * tilesY, shadeTile);
+}
+
+// ---------------- Integer annulus fill ----------------
+
+// Row half-widths of the outer and inner midpoint disks (hw[|y|] = max x), from
+// two midpoint circle walks (as in drawFilledCircleSymmetry) run in lockstep.
+// innerR < 0 means no hole.
+void annulusHalfWidths(int outerR, int innerR, std::vector<int> &hwOuter, std::vector<int> &hwInner)
+{
+    hwOuter.assign(outerR + 1, 0);
+    hwInner.assign(std::max(innerR, -1) + 1, 0);
+    int xo = outerR, yo = 0, dO = 1 - outerR;
+    int xi = innerR, yi = 0, dI = 1 - innerR;
+    bool outerDone = false, innerDone = innerR < 0;
+    while (!outerDone || !innerDone) {
+        if (!outerDone) {
+            hwOuter[yo] = std::max(hwOuter[yo], xo);
+            hwOuter[xo] = std::max(hwOuter[xo], yo);
+            ++yo;
+            if (dO < 0) dO += 2 * yo + 1;
+            else { --xo; dO += 2 * (yo - xo) + 1; }
+            outerDone = xo < yo;
+        }
+        if (!innerDone) {
+            hwInner[yi] = std::max(hwInner[yi], xi);
+            hwInner[xi] = std::max(hwInner[xi], yi);
+            ++yi;
+            if (dI < 0) dI += 2 * yi + 1;
+            else { --xi; dI += 2 * (yi - xi) + 1; }
+            innerDone = xi < yi;
+        }
+    }
+}
+
+// Store n copies of a packed RGBA value at dst. The byte image is written with
+// memcpy rather than through a uint32_t pointer (strict aliasing); copying
+// 16-pixel blocks from a local pattern keeps it as fast as std::fill
+inline void fillPixelsRGBA(unsigned char *dst, size_t n, uint32_t rgba)
+{
+    uint32_t block[16];
+    std::fill(block, block + 16, rgba);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) std::memcpy(dst + 4 * i, block, sizeof(block));
+    std::memcpy(dst + 4 * i, block, 4 * (n - i));
+}
+
+// Fill pixels [x1, x2] of image row y with one packed RGBA value (clipped)
+inline void fillSpanRGBA(unsigned char *img, int w, int h, int x1, int x2, int y, uint32_t rgba)
+{
+    if (y < 0 || y >= h) return;
+    x1 = std::max(x1, 0);
+    x2 = std::min(x2, w - 1);
+    if (x1 > x2) return;
+    fillPixelsRGBA(img + 4 * (size_t(y) * w + x1), size_t(x2 - x1 + 1), rgba);
+}
+
+// Pixels of the outer disk minus the inner disk: at most two spans per row
+void fillAnnulus(unsigned char *img, int w, int h, int cx, int cy, int innerR, int outerR, uint32_t rgba)
+{
+    if (outerR < 0 || innerR >= outerR) return;
+    static thread_local std::vector<int> hwOuter, hwInner;
+    annulusHalfWidths(outerR, innerR, hwOuter, hwInner);
+    for (int y = 0; y <= outerR; ++y) {
+        int xo = hwOuter[y];
+        for (int sy : { cy + y, cy - y }) {
+            if (y <= innerR) {
+                int xi = hwInner[y];
+                fillSpanRGBA(img, w, h, cx - xo, cx - xi - 1, sy, rgba);
+                fillSpanRGBA(img, w, h, cx + xi + 1, cx + xo, sy, rgba);
+            } else {
+                fillSpanRGBA(img, w, h, cx - xo, cx + xo, sy, rgba);
+            }
+            if (y == 0) break;
+        }
+    }
+}
+
+// Pack a color in [0..1] into RGBA8 (byte order r, g, b, a in memory)
+inline uint32_t packRGBA(float r, float g, float b)
+{
+    unsigned char px[4] = { static_cast<unsigned char>(255.0f * r + 0.5f), static_cast<unsigned char>(255.0f * g + 0.5f),
+                            static_cast<unsigned char>(255.0f * b + 0.5f), 255 };
+    uint32_t v;
+    std::memcpy(&v, px, 4);
+    return v;
+}
+
+// Binary rings: each ring is one integer annulus in its mid color, blended once
+// with its alpha over the background (the rings do not overlap)
+void renderRingsBinary(const std::vector<RingInstance> &rings, std::vector<unsigned char> &img, int w, int h)
+{
+    img.resize(size_t(w) * h * 4);
+    fillPixelsRGBA(img.data(), size_t(w) * h, packRGBA(BG_R, BG_G, BG_B));
+    for (const auto &r : rings) {
+        float a = 0.5f * (r.outer[3] + r.inner[3]);
+        float rgb[3], bg[3] = { BG_R, BG_G, BG_B };
+        for (int ch = 0; ch < 3; ++ch) rgb[ch] = bg[ch] + a * (0.5f * (r.outer[ch] + r.inner[ch]) - bg[ch]);
+        fillAnnulus(img.data(), w, h, static_cast<int>(std::lround(r.cx)), static_cast<int>(std::lround(r.cy)),
+                    static_cast<int>(std::lround(r.innerR)), static_cast<int>(std::lround(r.outerR)),
+                    packRGBA(rgb[0], rgb[1], rgb[2]));
+    }
+}
+
+// Render the full scene into the currently bound framebuffer
+void renderScene()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (useProceduralShading) {
+        // the CPU image only depends on the (constant) ring parameters
+        if (!cpuImageValid) {
+            shadeRingsProcedural(cpuImage, WINDOW_W, WINDOW_H);
+            cpuImageValid = true;
+        }
+        glRasterPos2i(0, 0);
+        glDrawPixels(WINDOW_W, WINDOW_H, GL_RGBA, GL_UNSIGNED_BYTE, cpuImage.data());
+        return;
+    }
+
+    if (useBinaryRings) {
+        if (!cpuImageValid) {
+            std::vector<RingInstance> rings;
+            buildSceneRings(rings);
+            renderRingsBinary(rings, cpuImage, WINDOW_W, WINDOW_H);
+            cpuImageValid = true;
+        }
+        glRasterPos2i(0, 0);
+        glDrawPixels(WINDOW_W, WINDOW_H, GL_RGBA, GL_UNSIGNED_BYTE, cpuImage.data());
+        return;
+    }
+
+    if (useSoftwareRaster) {
+        if (!cpuImageValid) {
+            rasterizeStripsSoftware(BAKED_RING_VERTICES.data, NUM_RINGS, RING_STRIP_VERTICES,
+                                    cpuImage, WINDOW_W, WINDOW_H);
+            cpuImageValid = true;
+        }
+        glRasterPos2i(0, 0);
+        glDrawPixels(WINDOW_W, WINDOW_H, GL_RGBA, GL_UNSIGNED_BYTE, cpuImage.data());
+        return;
+    }
+
+    if (useBakedGeometry) {
+        drawInterleavedRings(BAKED_RING_VERTICES.data, NUM_RINGS);
+        return;
+    }
+
+    std::vector<RingInstance> rings;
+    buildSceneRings(rings);
+    drawRings(rings);
+}
+
+#ifdef HAVE_INSTANCED_GL
+GLuint cacheFbo = 0, cacheTex = 0;
+// With a multisampled window the scene is drawn into a renderbuffer with the same
+// sample count and resolved into cacheTex, so the cached frame keeps the MSAA edges
+GLuint cacheMsFbo = 0, cacheMsRb = 0;
+GLint cacheSamples = 0;
+int cacheW = 0, cacheH = 0;
+bool sceneCacheReady = false;
+
+// Needs a current GL context; returns false without framebuffer objects (GL < 3.0)
+bool initSceneCache()
+{
+    if (!glVersionAtLeast(3, 0)) return false;
+    glGenFramebuffers(1, &cacheFbo);
+    glGenTextures(1, &cacheTex);
+
+    // sample count of the window's framebuffer (0 without GLUT_MULTISAMPLE support)
+    glGetIntegerv(GL_SAMPLES, &cacheSamples);
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    cacheSamples = std::min(cacheSamples, maxSamples);
+    if (cacheSamples > 1) {
+        glGenFramebuffers(1, &cacheMsFbo);
+        glGenRenderbuffers(1, &cacheMsRb);
+    } else {
+        cacheSamples = 0;
+    }
+    return true;
+}
+
+// Re-render the scene into the cache texture at window resolution
+void updateSceneCache()
+{
+    if (cacheW != windowW || cacheH != windowH) {
+        cacheW = windowW;
+        cacheH = windowH;
+        glBindTexture(GL_TEXTURE_2D, cacheTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheW, cacheH, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, cacheFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cacheTex, 0);
+        if (cacheSamples) {
+            glBindRenderbuffer(GL_RENDERBUFFER, cacheMsRb);
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, cacheSamples, GL_RGBA8, cacheW, cacheH);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, cacheMsFbo);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, cacheMsRb);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheSamples ? cacheMsFbo : cacheFbo);
+    renderScene();
+    if (cacheSamples) {
+        // resolve the samples into the cache texture
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, cacheMsFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cacheFbo);
+        glBlitFramebuffer(0, 0, cacheW, cacheH, 0, 0, cacheW, cacheH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    sceneCacheValid = true;
+}
+
+// Draw the cached texture over the whole window (a textured quad rather than
+// glBlitFramebuffer, which cannot target a multisampled window)
+void drawSceneCache()
+{
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, cacheTex);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glBegin(GL_QUADS);
+      glTexCoord2f(0, 0); glVertex2f(0, 0);
+      glTexCoord2f(1, 0); glVertex2f(static_cast<float>(WINDOW_W), 0);
+      glTexCoord2f(1, 1); glVertex2f(static_cast<float>(WINDOW_W), static_cast<float>(WINDOW_H));
+      glTexCoord2f(0, 1); glVertex2f(0, static_cast<float>(WINDOW_H));
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+}
+#endif
+
+// Draw a frame, through the scene cache when available
+void drawFrame()
+{
+#ifdef HAVE_INSTANCED_GL
+    if (useSceneCache && sceneCacheReady) {
+        if (!sceneCacheValid) updateSceneCache();
+        drawSceneCache();
+        return;
+    }
+#endif
+    renderScene();
+}
+
+// Name of the path renderScene()/drawFrame() take with the current settings
+std::string renderPathName()
+{
+    std::string name;
+    if (useProceduralShading) name = "CPU procedural shading";
+    else if (useBinaryRings) name = "binary integer rings";
+    else if (useSoftwareRaster) name = "software rasterizer, baked geometry";
+    else if (useBakedGeometry) name = "baked geometry";
+#ifdef HAVE_INSTANCED_GL
+    else if (useInstancedRings && instancedReady) name = "runtime geometry, instanced rings";
+#endif
+    else name = "runtime geometry, immediate-mode rings";
+#ifdef HAVE_INSTANCED_GL
+    if (useSceneCache && sceneCacheReady) name += ", scene cache";
+#endif
+    return name;
+}
+
+void display()
+{
+    static bool firstFrame = true;
+    auto t0 = std::chrono::steady_clock::now();
+    drawFrame();
+    glutSwapBuffers();
+
+    // Cold-start cost: time from process start until the first frame is on
+    // screen, split into startup (GLUT/GL setup) and the frame itself. Start
+    // with CIRCLE_GEOMETRY=baked to compare against the runtime geometry.
+    if (firstFrame) {
+        glFinish();
+        auto t1 = std::chrono::steady_clock::now();
+        double totalMs = std::chrono::duration<double, std::milli>(t1 - programStart).count();
+        double frameMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        std::cout << "First frame (" << renderPathName() << ") after " << totalMs
+                  << " ms from start (startup " << totalMs - frameMs << " ms, frame " << frameMs << " ms)\n";
+        firstFrame = false;
+    }
+}
+
+// Radar-plot style stress scene: a grid of small ring stacks
+void buildManyRings(int count, std::vector<RingInstance> &rings)
+{
+    rings.clear();
+    int perRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    float cell = static_cast<float>(WINDOW_W) / perRow;
+    for (int i = 0; i < count; ++i) {
+        float t = static_cast<float>(i % 7) / 6.0f;
+        RingInstance r{ (i % perRow + 0.5f) * cell, (i / perRow + 0.5f) * cell,
+                        cell * (0.1f + 0.05f * (i % 7)), cell * (0.14f + 0.05f * (i % 7)), {}, {} };
+        hsvToRgb(330.0f - 120.0f * t, 0.8f, 0.95f, r.outer[0], r.outer[1], r.outer[2]);
+        hsvToRgb(330.0f - 120.0f * t, 0.8f, 0.8f, r.inner[0], r.inner[1], r.inner[2]);
+        r.outer[3] = r.inner[3] = 0.9f;
+        rings.push_back(r);
+    }
+}
+
+// Trig-per-vertex vs recurrence table: vertex generation time for all scene
+// rings and worst position error on the outermost ring
+void benchmarkRingVertexGeneration()
+{
+    const int segs = std::max(3, SEGMENTS);
+    std::vector<RingInstance> rings;
+    buildSceneRings(rings);
+    std::vector<float> xy;
+    xy.reserve(rings.size() * (segs + 1) * 4);
+    const int reps = 200;
+
+    auto timeIt = [&](auto &&gen) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < reps; ++rep) {
+            xy.clear();
+            gen();
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / reps;
+    };
+    // old drawRing behaviour: cosf/sinf for every vertex of every ring
+    double tTrig = timeIt([&] {
+        UnitCircle unit;
+        for (const auto &r : rings) {
+            unitCircleTrig(segs, unit);
+            generateRingStrip(r, unit, xy);
+        }
+    });
+    // one recurrence table shared by all rings
+    double tRec = timeIt([&] {
+        UnitCircle unit;
+        unitCircleRecurrence(segs, unit);
+        for (const auto &r : rings) generateRingStrip(r, unit, xy);
+    });
+    // the same table, generated across rings
+    double tBatch = timeIt([&] {
+        UnitCircle unit;
+        unitCircleRecurrence(segs, unit);
+        generateRingStrips(rings, unit, xy);
+    });
+
+    UnitCircle exact, rec;
+    unitCircleTrig(segs, exact);
+    unitCircleRecurrence(segs, rec);
+    double maxErr = 0.0;
+    for (int i = 0; i <= segs; ++i)
+        maxErr = std::max(maxErr, std::hypot(double(exact.c[i]) - rec.c[i], double(exact.s[i]) - rec.s[i]));
+    std::cout << "  ring vertices (" << rings.size() << " rings): trig " << tTrig << " us, recurrence "
+              << tRec << " us, across rings " << tBatch << " us; max error " << maxErr * rings.back().outerR << " px at r = "
+              << rings.back().outerR << "\n";
+}
+
+// Average ms per frame (glFinish-synchronized) of drawing the rings each way
+void benchmarkRingPaths()
+{
+    auto timeFrames = [](const std::vector<RingInstance> &rings, void (*draw)(const std::vector<RingInstance>&)) {
+        const int frames = 10;
+        draw(rings);
+        glFinish();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            draw(rings);
+        }
+        glFinish();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+    };
+
+    std::vector<RingInstance> scene, many;
+    buildSceneRings(scene);
+    buildManyRings(10000, many);
+    std::cout << "Ring rendering (ms/frame):\n";
+    std::cout << "  scene (" << scene.size() << " rings): glBegin " << timeFrames(scene, drawRingsImmediate);
+#ifdef HAVE_INSTANCED_GL
+    if (instancedReady) std::cout << ", instanced " << timeFrames(scene, drawRingsInstanced);
+#endif
+    std::cout << "\n  grid (" << many.size() << " rings): glBegin " << timeFrames(many, drawRingsImmediate);
+#ifdef HAVE_INSTANCED_GL
+    if (instancedReady) std::cout << ", instanced " << timeFrames(many, drawRingsInstanced);
+#endif
+    std::cout << "\n";
+
+    const int frames = 20;
+    std::vector<unsigned char> img;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) shadeRingsProcedural(img, WINDOW_W, WINDOW_H);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+    std::cout << "  procedural CPU shading: " << ms << " ms/frame ("
+              << double(WINDOW_W) * WINDOW_H / (ms * 1e3) << " Mpixel/s)\n";
+
+    // Repeated redraws of the static scene, uncached vs through the cache
+    auto timeRedraws = [](bool cached) {
+        const int frames = 20;
+        bool saved = useSceneCache;
+        useSceneCache = cached;
+        drawFrame();
+        glFinish();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f) drawFrame();
+        glFinish();
+        useSceneCache = saved;
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+    };
+    std::cout << "  redraw: uncached " << timeRedraws(false) << " ms/frame, cached " << timeRedraws(true) << " ms/frame\n";
+
+    // Software half-space rasterizer over the same strip data (SIMD quads vs scalar)
+    std::vector<RingInstance> gridRings;
+    std::vector<float> gridBuf;
+    buildManyRings(2000, gridRings);
+    buildRingVertexBuffer(gridRings, gridBuf);
+    auto timeSoftware = [&](const float *data, int numRings, bool simd) {
+        const int frames = 10;
+        bool saved = useSimdQuads;
+        useSimdQuads = simd;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; ++f)
+            rasterizeStripsSoftware(data, numRings, RING_STRIP_VERTICES, img, WINDOW_W, WINDOW_H);
+        useSimdQuads = saved;
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+    };
+    std::cout << "  software raster: scene " << timeSoftware(BAKED_RING_VERTICES.data, NUM_RINGS, true)
+              << " ms (scalar " << timeSoftware(BAKED_RING_VERTICES.data, NUM_RINGS, false) << "), grid of "
+              << gridRings.size() << " rings " << timeSoftware(gridBuf.data(), int(gridRings.size()), true)
+              << " ms (scalar " << timeSoftware(gridBuf.data(), int(gridRings.size()), false) << ")\n";
+
+    // Integer annulus fill: 2000 concentric rings on a 4096^2 image (1 px wide, then
+    // 200 rings 10 px wide), against plain span fills of the same image
+    {
+        const int size = 4096;
+        std::vector<unsigned char> big(size_t(size) * size * 4);
+        auto timeRings = [&](int count, int width) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < count; ++i)
+                fillAnnulus(big.data(), size, size, size / 2, size / 2, i * width, (i + 1) * width, 0xFFFFFFFFu);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            double r = double(count) * width;
+            return PI * r * r / (ms * 1e3);
+        };
+        double thin = timeRings(2000, 1), thick = timeRings(200, 10);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int y = 0; y < size; ++y) fillSpanRGBA(big.data(), size, size, 0, size - 1, y, 0u);
+        double fillMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::cout << "  binary annuli (Mpixel/s): 2000 x 1 px " << thin << ", 200 x 10 px " << thick
+                  << "; plain span fill " << double(size) * size / (fillMs * 1e3) << "\n";
+    }
+
+    benchmarkRingVertexGeneration();
+
+    // Fresh frame in a warm process: the runtime path builds the vertex buffer
+    // first, the baked path only draws. The cold-start figure is the "First
+    // frame" line printed at startup (CIRCLE_GEOMETRY=baked or runtime).
+    std::vector<float> runtimeBuf;
+    glFinish();
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<RingInstance> sceneRings;
+    buildSceneRings(sceneRings);
+    buildRingVertexBuffer(sceneRings, runtimeBuf);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawInterleavedRings(runtimeBuf.data(), NUM_RINGS);
+    glFinish();
+    double runtimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+    auto t2 = std::chrono::steady_clock::now();
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawInterleavedRings(BAKED_RING_VERTICES.data, NUM_RINGS);
+    glFinish();
+    double bakedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t2).count();
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < runtimeBuf.size(); ++i)
+        maxDiff = std::max(maxDiff, std::fabs(double(runtimeBuf[i]) - BAKED_RING_VERTICES.data[i]));
+    std::cout << "  warm frame from scratch: runtime geometry " << runtimeMs << " ms (build " << buildMs
+              << " ms), baked " << bakedMs << " ms; baked buffer " << sizeof(RingVertexBuffer)
+              << " bytes, max diff vs runtime " << maxDiff << "\n";
+    glutPostRedisplay();
+}
+
+void reshape(int w, int h)
+{
+    // Keep coordinate system fixed to pixel-like coords for simplicity
+    glViewport(0, 0, w, h);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    // Map x: [0..WINDOW_W], y: [0..WINDOW_H]
+    gluOrtho2D(0.0, static_cast<double>(WINDOW_W), 0.0, static_cast<double>(WINDOW_H));
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // stretch CPU-shaded images to the window like the geometry
+    glPixelZoom(static_cast<float>(w) / WINDOW_W, static_cast<float>(h) / WINDOW_H);
+
+    windowW = w;
+    windowH = h;
+    sceneCacheValid = false;
+}
+
+void keyboard(unsigned char key, int, int)
+{
+    if (key == 'b' || key == 'B') {
+        benchmarkRingPaths();
+        return;
+    }
+    if (key == 'g' || key == 'G') {
+        useBakedGeometry = !useBakedGeometry;
+        sceneCacheValid = false;
+        glutPostRedisplay();
+        return;
+    }
+    if (key == 'p' || key == 'P') {
+        useProceduralShading = !useProceduralShading;
+        cpuImageValid = false;
+        sceneCacheValid = false;
+        glutPostRedisplay();
+        return;
+    }
+    if (key == 'i' || key == 'I') {
+        useBinaryRings = !useBinaryRings;
+        cpuImageValid = false;
+        sceneCacheValid = false;
+        glutPostRedisplay();
+        return;
+    }
+    if (key == 's' || key == 'S') {
+        useSoftwareRaster = !useSoftwareRaster;
+        cpuImageValid = false;
+        sceneCacheValid = false;
+        glutPostRedisplay();
+        return;
+    }
+    if (key == 27 || key == 'q' || key == 'Q') {
+        // Try to exit politely. If using older GLUT without glutLeaveMainLoop, use exit().
+#if defined(GLUT_API_VERSION) && (GLUT_API_VERSION >= 4)
+        // freeglut provides glutLeaveMainLoop()
+        //glutLeaveMainLoop();
+#else
+        exit(0);
+#endif
+    }
+}
+
+int main(int argc, char** argv)
+{
+    programStart = std::chrono::steady_clock::now();
+    // CIRCLE_GEOMETRY=baked starts on the baked vertex buffer instead of
+    // building the rings at runtime, so both cold starts can be timed
+    if (const char* geometry = std::getenv("CIRCLE_GEOMETRY"))
+        useBakedGeometry = std::strcmp(geometry, "baked") == 0;
+    glutInit(&argc, argv);
+
+    // Request double-buffered RGBA window with multisampling if supported
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_MULTISAMPLE);
+    glutInitWindowSize(WINDOW_W, WINDOW_H);
+    glutInitWindowPosition(200, 100);
+    glutCreateWindow("Beautiful Concentric Circles - Fixed");
+
+    // Enable blending and multisampling for smooth, glowing look
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    //glEnable(GL_MULTISAMPLE);
+
+    // Background (dark)
+    glClearColor(BG_R, BG_G, BG_B, 1.0f);
+
+#ifdef HAVE_INSTANCED_GL
+    if (useInstancedRings) {
+        instancedReady = initInstancedRings();
+        std::cout << (instancedReady ? "Using instanced ring rendering.\n"
+                                     : "GL 3.3 not available; using immediate-mode rings.\n");
+    }
+    if (useSceneCache) sceneCacheReady = initSceneCache();
+#endif
+    std::cout << "Press 'p' to toggle CPU procedural shading, 's' to toggle the software rasterizer,\n"
+                 "'i' to toggle binary integer rings, 'g' to toggle baked geometry,\n"
+                 "'b' to benchmark ring rendering, ESC or 'q' to quit.\n";
+
+    // Callbacks
+    glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
+    glutKeyboardFunc(keyboard);
+
+    // Enter main loop
+    glutMainLoop();
+
+    return 0;
+}
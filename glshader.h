@@ -0,0 +1,85 @@
+// glshader.h
+// GL 3.x helpers shared by the drawing programs: version check, shader compile
+// and program link. Include it in place of <GL/glut.h>.
+//
+// The GL 3.x entry points the programs use (instancing, GLSL, framebuffer
+// objects) are exported by libGL itself on Linux/macOS, so prototypes are
+// enabled and HAVE_INSTANCED_GL is defined there. Other platforms would need an
+// extension loader and keep the immediate-mode paths instead.
+
+#ifndef GLSHADER_H
+#define GLSHADER_H
+
+#ifndef _WIN32
+#define GL_GLEXT_PROTOTYPES
+#define HAVE_INSTANCED_GL 1
+#endif
+
+#include <GL/glut.h>
+
+#ifdef HAVE_INSTANCED_GL
+
+#include <cstdio>
+#include <initializer_list>
+#include <iostream>
+
+// Needs a current GL context
+inline bool glVersionAtLeast(int wantMajor, int wantMinor)
+{
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int major = 0, minor = 0;
+    if (!version || std::sscanf(version, "%d.%d", &major, &minor) != 2) return false;
+    return major > wantMajor || (major == wantMajor && minor >= wantMinor);
+}
+
+// Returns 0 (after printing the info log) when compilation fails
+inline GLuint compileShader(GLenum type, const char* src)
+{
+    GLuint sh = glCreateShader(type);
+    glShaderSource(sh, 1, &src, nullptr);
+    glCompileShader(sh);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetShaderInfoLog(sh, sizeof(log), nullptr, log);
+        std::cerr << "Shader compile error: " << log << "\n";
+        glDeleteShader(sh);
+        return 0;
+    }
+    return sh;
+}
+
+// attribs: names bound to locations 0, 1, ...
+inline GLuint linkProgram(const char* vsSrc, const char* fsSrc, std::initializer_list<const char*> attribs)
+{
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vsSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fsSrc);
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+    GLuint prog = glCreateProgram();
+    glAttachShader(prog, vs);
+    glAttachShader(prog, fs);
+    GLuint loc = 0;
+    for (const char* name : attribs) glBindAttribLocation(prog, loc++, name);
+    glLinkProgram(prog);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        glGetProgramInfoLog(prog, sizeof(log), nullptr, log);
+        std::cerr << "Program link error: " << log << "\n";
+        glDeleteProgram(prog);
+        return 0;
+    }
+    return prog;
+}
+
+#endif // HAVE_INSTANCED_GL
+
+#endif // GLSHADER_H
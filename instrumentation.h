@@ -0,0 +1,167 @@
+// instrumentation.h
+// Hot-path counters and scoped timers shared by the drawing programs.
+// Build with -DENABLE_INSTRUMENTATION to collect them; otherwise every macro
+// expands to nothing and the instrumented code compiles exactly as before.
+//
+//   INSTR_COUNT("thick.pixels_emitted", n);   // add n to a named counter
+//   INSTR_SCOPE("thick.stamp");               // time the enclosing scope
+//
+// Each thread accumulates into its own slots (no atomics or locks on the hot
+// path); a thread's slots are merged into the totals when it exits, and the
+// totals are reported at program exit as text on stdout and as JSON in
+// $INSTRUMENTATION_JSON (default instrumentation.json).
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#ifdef ENABLE_INSTRUMENTATION
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace instr {
+
+struct Slot {
+    uint64_t count = 0;   // counter value, or number of timed scopes
+    uint64_t ns = 0;      // timers only
+};
+
+class Registry {
+public:
+    // Id for a name; sites using the same name share one slot
+    size_t add(const char *name, bool timer)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < names.size(); ++i)
+            if (names[i] == name) return i;
+        names.emplace_back(name);
+        isTimer.push_back(timer);
+        totals.emplace_back();
+        return names.size() - 1;
+    }
+
+    void merge(const std::vector<Slot> &slots)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < slots.size() && i < totals.size(); ++i) {
+            totals[i].count += slots[i].count;
+            totals[i].ns += slots[i].ns;
+        }
+        ++threads;
+    }
+
+    // Thread-local slots of the main thread are merged before this runs
+    ~Registry() { report(); }
+
+private:
+    void report()
+    {
+        if (names.empty()) return;
+        std::printf("Instrumentation (%u thread%s):\n", threads, threads == 1 ? "" : "s");
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (isTimer[i])
+                std::printf("  %-28s %10llu calls %12.3f ms\n", names[i].c_str(),
+                            (unsigned long long)totals[i].count, totals[i].ns / 1e6);
+            else
+                std::printf("  %-28s %10llu\n", names[i].c_str(), (unsigned long long)totals[i].count);
+        }
+
+        const char *path = std::getenv("INSTRUMENTATION_JSON");
+        if (!path) path = "instrumentation.json";
+        FILE *f = std::fopen(path, "w");
+        if (!f) {
+            std::cerr << "Could not write " << path << "\n";
+            return;
+        }
+        std::fprintf(f, "{\n  \"threads\": %u,\n  \"counters\": {", threads);
+        const char *sep = "";
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (isTimer[i]) continue;
+            std::fprintf(f, "%s\n    \"%s\": %llu", sep, names[i].c_str(), (unsigned long long)totals[i].count);
+            sep = ",";
+        }
+        std::fprintf(f, "\n  },\n  \"timers\": {");
+        sep = "";
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (!isTimer[i]) continue;
+            std::fprintf(f, "%s\n    \"%s\": { \"calls\": %llu, \"ms\": %.3f }", sep, names[i].c_str(),
+                         (unsigned long long)totals[i].count, totals[i].ns / 1e6);
+            sep = ",";
+        }
+        std::fprintf(f, "\n  }\n}\n");
+        std::fclose(f);
+        std::printf("Instrumentation written to %s\n", path);
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::vector<bool> isTimer;
+    std::vector<Slot> totals;
+    unsigned threads = 0;
+};
+
+inline Registry &registry()
+{
+    static Registry r;
+    return r;
+}
+
+// Per-thread slots, merged into the registry when the thread exits
+struct ThreadSlots {
+    std::vector<Slot> slots;
+    ~ThreadSlots() { registry().merge(slots); }
+};
+
+inline Slot &slot(size_t id)
+{
+    thread_local ThreadSlots local;
+    if (id >= local.slots.size()) local.slots.resize(id + 1);
+    return local.slots[id];
+}
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(size_t id) : id(id), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer()
+    {
+        Slot &s = slot(id);
+        ++s.count;
+        s.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    size_t id;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace instr
+
+#define INSTR_CONCAT_(a, b) a##b
+#define INSTR_CONCAT(a, b) INSTR_CONCAT_(a, b)
+
+#define INSTR_COUNT(name, n)                                                          \
+    do {                                                                              \
+        static const size_t instrId_ = instr::registry().add(name, false);            \
+        instr::slot(instrId_).count += static_cast<uint64_t>(n);                      \
+    } while (0)
+
+#define INSTR_SCOPE(name)                                                             \
+    static const size_t INSTR_CONCAT(instrId_, __LINE__) = instr::registry().add(name, true); \
+    instr::ScopedTimer INSTR_CONCAT(instrTimer_, __LINE__)(INSTR_CONCAT(instrId_, __LINE__))
+
+#else
+
+// Compiled out: the count expression is not evaluated
+#define INSTR_COUNT(name, n) ((void)sizeof(n))
+#define INSTR_SCOPE(name) ((void)0)
+
+#endif // ENABLE_INSTRUMENTATION
+
+#endif // INSTRUMENTATION_H